@@ -0,0 +1,136 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <batched.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/mdspan>
+#include <layout_contiguous.hpp>
+#include <vector>
+
+#include "benchmark.hpp"
+
+using namespace std::experimental;
+
+namespace
+{
+
+/// Reference: one item at a time, each matrix being stored contiguously
+template < std::size_t N >
+void
+scalar_solve( mdspan< const double, extents< int, dynamic_extent, N, N >, layout_right > a,
+              mdspan< double, extents< int, dynamic_extent, N >, layout_right > x )
+{
+    for ( int b = 0; b < a.extent( 0 ); ++b )
+    {
+        double m[ N ][ N ];
+        int p[ N ];
+        double xb[ N ];
+        for ( std::size_t i = 0; i < N; ++i )
+        {
+            xb[ i ] = x( b, i );
+            for ( std::size_t j = 0; j < N; ++j )
+            {
+                m[ i ][ j ] = a( b, i, j );
+            }
+        }
+        detail::small_lu( m, p );
+        detail::small_lu_solve( m, p, xb );
+        for ( std::size_t i = 0; i < N; ++i )
+        {
+            x( b, i ) = xb[ i ];
+        }
+    }
+}
+
+template < std::size_t N >
+void
+scalar_matvec( mdspan< double, extents< int, dynamic_extent, N >, layout_right > y,
+               mdspan< const double, extents< int, dynamic_extent, N, N >, layout_right > a,
+               mdspan< const double, extents< int, dynamic_extent, N >, layout_right > x )
+{
+    for ( int b = 0; b < a.extent( 0 ); ++b )
+    {
+        for ( std::size_t i = 0; i < N; ++i )
+        {
+            double sum = 0.;
+            for ( std::size_t j = 0; j < N; ++j )
+            {
+                sum += a( b, i, j ) * x( b, j );
+            }
+            y( b, i ) = sum;
+        }
+    }
+}
+
+template < std::size_t N >
+void
+run( int n_batch )
+{
+    std::vector< double > a_data( std::size_t( n_batch ) * N * N );
+    std::vector< double > x_data( std::size_t( n_batch ) * N, 1. );
+    std::vector< double > y_data( x_data.size() );
+    for ( std::size_t i = 0; i < a_data.size(); ++i )
+    {
+        a_data[ i ] = 1. + ( i * 7 ) % 5;
+    }
+    mdspan< const double, extents< int, dynamic_extent, N, N >, layout_contiguous_at_left > a( a_data.data(),
+                                                                                               n_batch );
+    mdspan< double, extents< int, dynamic_extent, N >, layout_contiguous_at_left > x( x_data.data(), n_batch );
+    mdspan< double, extents< int, dynamic_extent, N >, layout_contiguous_at_left > y( y_data.data(), n_batch );
+    mdspan< const double, extents< int, dynamic_extent, N, N >, layout_right > a_aos( a_data.data(), n_batch );
+    mdspan< double, extents< int, dynamic_extent, N >, layout_right > x_aos( x_data.data(), n_batch );
+    mdspan< double, extents< int, dynamic_extent, N >, layout_right > y_aos( y_data.data(), n_batch );
+
+    double const bytes_matvec = sizeof( double ) * ( a_data.size() + 2. * x_data.size() );
+    double const bytes_solve = sizeof( double ) * ( a_data.size() + 2. * x_data.size() );
+    // The solves overwrite x with the solution: restore the right-hand sides before each timed call
+    std::vector< double > const x0_data = x_data;
+    auto const reset_x = [ & ] { std::copy( x0_data.begin(), x0_data.end(), x_data.begin() ); };
+    char name[ 64 ];
+    std::snprintf( name, sizeof( name ), "%zux%zu matvec per-item scalar", N, N );
+    report( name, best_time( 10, [ & ] { scalar_matvec< N >( y_aos, a_aos, x_aos ); } ), bytes_matvec );
+    std::snprintf( name, sizeof( name ), "%zux%zu matvec batched", N, N );
+    report( name, best_time( 10, [ & ] { batched_matvec( y, a, x ); } ), bytes_matvec );
+    std::snprintf( name, sizeof( name ), "%zux%zu solve per-item scalar", N, N );
+    report( name, best_time( 10, [ & ] { scalar_solve< N >( a_aos, x_aos ); }, reset_x ), bytes_solve );
+    std::snprintf( name, sizeof( name ), "%zux%zu solve batched", N, N );
+    report( name, best_time( 10, [ & ] { batched_solve( a, x ); }, reset_x ), bytes_solve );
+    std::snprintf( name, sizeof( name ), "%zux%zu solve batched parallel", N, N );
+    report( name, best_time( 10, [ & ] { batched_solve( parallel_execution {}, a, x ); }, reset_x ), bytes_solve );
+}
+
+} // namespace
+
+int
+main( int argc, char** argv )
+{
+    int const n_batch = argc > 1 ? std::atoi( argv[ 1 ] ) : 1 << 20;
+    std::printf( "%d batch items\n", n_batch );
+    run< 3 >( n_batch );
+    run< 4 >( n_batch );
+    run< 5 >( n_batch );
+    return 0;
+}
@@ -0,0 +1,108 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <convert.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/mdspan>
+#include <layout_contiguous.hpp>
+#include <memory.hpp>
+#include <traversal.hpp>
+
+#include "benchmark.hpp"
+
+using namespace std::experimental;
+
+namespace
+{
+
+template < class T, class Layout >
+using span_3d = mdspan< T, dextents< int, 3 >, Layout >;
+
+/// Reference: element-wise `static_cast` in lexicographic order
+template < class D, class DL, class S, class SL >
+void
+static_cast_copy( span_3d< D, DL > const& dst, span_3d< S const, SL > const& src )
+{
+    for ( int i = 0; i < dst.extent( 0 ); ++i )
+    {
+        for ( int j = 0; j < dst.extent( 1 ); ++j )
+        {
+            for ( int k = 0; k < dst.extent( 2 ); ++k )
+            {
+                dst( i, j, k ) = static_cast< D >( src( i, j, k ) );
+            }
+        }
+    }
+}
+
+template < class D, class S, class SL >
+void
+run( char const* types, char const* layouts, int n, int n_repeat )
+{
+    std::size_t const size = std::size_t( n ) * n * n;
+    aligned_vector< S > src_data( size );
+    aligned_vector< D > dst_data( size );
+    for ( std::size_t i = 0; i < size; ++i )
+    {
+        src_data[ i ] = static_cast< S >( 1.f / float( i % 1000 + 1 ) );
+    }
+    span_3d< S const, SL > const src( src_data.data(), n, n, n );
+    span_3d< D, layout_contiguous_at_right > const dst( dst_data.data(), n, n, n );
+    double const bytes = double( sizeof( S ) + sizeof( D ) ) * size;
+    char name[ 64 ];
+
+    std::snprintf( name, sizeof( name ), "%s %s static_cast", types, layouts );
+    report( name, best_time( n_repeat, [ & ] { static_cast_copy( dst, src ); } ), bytes );
+    std::snprintf( name, sizeof( name ), "%s %s convert_copy", types, layouts );
+    report( name, best_time( n_repeat, [ & ] { convert_copy( dst, src ); } ), bytes );
+    if constexpr ( std::is_same_v< SL, layout_contiguous_at_left > )
+    {
+        std::snprintf( name, sizeof( name ), "%s %s convert_copy morton", types, layouts );
+        report( name, best_time( n_repeat, [ & ] { convert_copy( morton_order<> {}, dst, src ); } ), bytes );
+    }
+    std::snprintf( name, sizeof( name ), "%s %s convert_copy parallel", types, layouts );
+    report( name, best_time( n_repeat, [ & ] { convert_copy( parallel_execution {}, dst, src ); } ), bytes );
+}
+
+} // namespace
+
+int
+main( int argc, char** argv )
+{
+    int const n = argc > 1 ? std::atoi( argv[ 1 ] ) : 256;
+    int const n_repeat = argc > 2 ? std::atoi( argv[ 2 ] ) : 10;
+    std::printf( "Conversion copies of %d^3 elements to layout_contiguous_at_right\n", n );
+    run< float, double, layout_contiguous_at_right >( "f64->f32", "right", n, n_repeat );
+    run< double, float, layout_contiguous_at_right >( "f32->f64", "right", n, n_repeat );
+    run< float16, float, layout_contiguous_at_right >( "f32->f16", "right", n, n_repeat );
+    run< float, float16, layout_contiguous_at_right >( "f16->f32", "right", n, n_repeat );
+    run< bfloat16, float, layout_contiguous_at_right >( "f32->bf16", "right", n, n_repeat );
+    run< float, bfloat16, layout_contiguous_at_right >( "bf16->f32", "right", n, n_repeat );
+    run< float16, double, layout_contiguous_at_right >( "f64->f16", "right", n, n_repeat );
+    run< float, double, layout_contiguous_at_left >( "f64->f32", "left", n, n_repeat );
+    run< float16, float, layout_contiguous_at_left >( "f32->f16", "left", n, n_repeat );
+    return 0;
+}
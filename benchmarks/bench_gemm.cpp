@@ -0,0 +1,97 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/mdspan>
+#include <gemm.hpp>
+#include <layout_contiguous.hpp>
+#include <vector>
+
+#include "benchmark.hpp"
+
+using namespace std::experimental;
+
+namespace
+{
+
+void
+naive_gemm( mdspan< double, dextents< int, 2 >, layout_stride > c,
+            mdspan< const double, dextents< int, 2 >, layout_stride > a,
+            mdspan< const double, dextents< int, 2 >, layout_stride > b )
+{
+#pragma omp parallel for
+    for ( int i = 0; i < c.extent( 0 ); ++i )
+    {
+        for ( int j = 0; j < c.extent( 1 ); ++j )
+        {
+            c( i, j ) = 0.;
+        }
+        for ( int p = 0; p < a.extent( 1 ); ++p )
+        {
+            for ( int j = 0; j < c.extent( 1 ); ++j )
+            {
+                c( i, j ) += a( i, p ) * b( p, j );
+            }
+        }
+    }
+}
+
+} // namespace
+
+int
+main( int argc, char** argv )
+{
+    int const n_max = argc > 1 ? std::atoi( argv[ 1 ] ) : 4096;
+    int const naive_max = 1024;
+    for ( int n = 8; n <= n_max; n *= 2 )
+    {
+        std::vector< double > a_data( std::size_t( n ) * n, 1. );
+        std::vector< double > b_data( a_data.size(), 1. );
+        std::vector< double > c_data( a_data.size(), 0. );
+        mdspan< const double, dextents< int, 2 >, layout_contiguous_at_left > a( a_data.data(), n, n );
+        mdspan< const double, dextents< int, 2 >, layout_contiguous_at_right > b( b_data.data(), n, n );
+        mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > c( c_data.data(), n, n );
+        int const n_repeat = n <= 256 ? 20 : 3;
+        double const flops = 2. * n * n * n;
+        double const bytes = 3. * sizeof( double ) * a_data.size();
+        char name[ 64 ];
+
+        if ( n <= naive_max )
+        {
+            mdspan< const double, dextents< int, 2 >, layout_stride > a_stride( a.data_handle(), a.mapping() );
+            mdspan< const double, dextents< int, 2 >, layout_stride > b_stride( b.data_handle(), b.mapping() );
+            mdspan< double, dextents< int, 2 >, layout_stride > c_stride( c.data_handle(), c.mapping() );
+            std::snprintf( name, sizeof( name ), "n=%d naive", n );
+            report( name, best_time( n_repeat, [ & ] { naive_gemm( c_stride, a_stride, b_stride ); } ), bytes,
+                    flops );
+        }
+        std::snprintf( name, sizeof( name ), "n=%d gemm sequential", n );
+        report( name, best_time( n_repeat, [ & ] { gemm( 1., a, b, 0., c ); } ), bytes, flops );
+        std::snprintf( name, sizeof( name ), "n=%d gemm parallel", n );
+        report( name, best_time( n_repeat, [ & ] { gemm( parallel_execution {}, 1., a, b, 0., c ); } ), bytes,
+                flops );
+    }
+    return 0;
+}
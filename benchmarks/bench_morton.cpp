@@ -0,0 +1,95 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <algorithms.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/mdspan>
+#include <layout_contiguous.hpp>
+#include <memory.hpp>
+#include <numeric>
+#include <traversal.hpp>
+#include <utility>
+
+#include "benchmark.hpp"
+
+using namespace std::experimental;
+
+namespace
+{
+
+using left_span = mdspan< double, dextents< int, 3 >, layout_contiguous_at_left >;
+using right_span = mdspan< double, dextents< int, 3 >, layout_contiguous_at_right >;
+
+/// Fixed tiles of `tile x tile` runs visited in lexicographic order
+void
+tiled_copy( right_span const& dst, left_span const& src, int tile )
+{
+    for ( int i = 0; i < dst.extent( 0 ); i += tile )
+    {
+        std::pair< int, int > const is( i, std::min( i + tile, dst.extent( 0 ) ) );
+        for ( int j = 0; j < dst.extent( 1 ); j += tile )
+        {
+            std::pair< int, int > const js( j, std::min( j + tile, dst.extent( 1 ) ) );
+            copy_elements( submdspan( dst, is, js, full_extent ), submdspan( src, is, js, full_extent ) );
+        }
+    }
+}
+
+} // namespace
+
+int
+main( int argc, char** argv )
+{
+    int const max_n = argc > 1 ? std::atoi( argv[ 1 ] ) : 256;
+    std::printf( "3D transposing copy from layout_contiguous_at_left to layout_contiguous_at_right\n" );
+    for ( int n = 32; n <= max_n; n *= 2 )
+    {
+        std::size_t const size = std::size_t( n ) * n * n;
+        aligned_vector< double > src_data( size );
+        aligned_vector< double > dst_data( size );
+        std::iota( src_data.begin(), src_data.end(), 0. );
+        left_span const src( src_data.data(), n, n, n );
+        right_span const dst( dst_data.data(), n, n, n );
+        double const bytes = 2. * sizeof( double ) * size;
+        int const n_repeat = std::max( 1, int( ( 1 << 24 ) / size ) );
+        char name[ 64 ];
+
+        std::snprintf( name, sizeof( name ), "n=%d lexicographic", n );
+        report( name, best_time( n_repeat, [ & ] { copy_elements( dst, src ); } ), bytes );
+        for ( int tile : { 8, 32 } )
+        {
+            std::snprintf( name, sizeof( name ), "n=%d fixed tiles %d", n, tile );
+            report( name, best_time( n_repeat, [ & ] { tiled_copy( dst, src, tile ); } ), bytes );
+        }
+        for ( std::size_t leaf : { 2, 4, 8 } )
+        {
+            std::snprintf( name, sizeof( name ), "n=%d morton leaf %zu", n, leaf );
+            report( name, best_time( n_repeat, [ & ] { copy_elements( morton_order<> { leaf }, dst, src ); } ),
+                    bytes );
+        }
+    }
+    return 0;
+}
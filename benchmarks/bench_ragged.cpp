@@ -0,0 +1,88 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithms.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/mdspan>
+#include <functional>
+#include <layout_contiguous.hpp>
+#include <layout_ragged.hpp>
+#include <random>
+#include <vector>
+
+#include "benchmark.hpp"
+
+using namespace std::experimental;
+
+int
+main( int argc, char** argv )
+{
+    int const n_rows = argc > 1 ? std::atoi( argv[ 1 ] ) : 1 << 16;
+    int const max_row_size = argc > 2 ? std::atoi( argv[ 2 ] ) : 256;
+
+    // Skewed row sizes: most rows are much shorter than the longest one
+    std::mt19937 gen( 42 );
+    std::uniform_real_distribution< double > dist( 0., 1. );
+    std::vector< int > row_sizes( n_rows );
+    for ( int& size : row_sizes )
+    {
+        size = int( max_row_size * std::pow( dist( gen ), 1.5 ) );
+    }
+    std::vector< int > const row_offsets = ragged_row_offsets( row_sizes.begin(), row_sizes.end() );
+    dextents< int, 2 > const e = ragged_extents( row_offsets.data(), n_rows );
+    int const n_values = row_offsets.back();
+
+    std::vector< double > r_data( n_values, 1. );
+    std::vector< double > p_data( std::size_t( e.extent( 0 ) ) * e.extent( 1 ) );
+    mdspan< double, dextents< int, 2 >, layout_ragged_contiguous > const r(
+        r_data.data(), layout_ragged_contiguous::mapping< dextents< int, 2 > >( e, row_offsets.data() ) );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > const p( p_data.data(), e );
+    copy_to_padded( p, r, 0. );
+
+    double const r_bytes = sizeof( double ) * n_values + sizeof( int ) * row_offsets.size();
+    double const p_bytes = sizeof( double ) * p_data.size();
+    std::printf( "%d rows of at most %d elements\n", n_rows, e.extent( 1 ) );
+    std::printf( "ragged: %.1f MB, padded: %.1f MB (%.0f%% padding)\n", r_bytes * 1e-6, p_bytes * 1e-6,
+                 100. * ( 1. - double( n_values ) / p_data.size() ) );
+
+    auto const id = []( double x ) { return x; };
+    auto const twice = []( double x ) { return 2 * x; };
+    double sink = 0.;
+    report( "sum ragged", best_time( 10, [ & ] { sink += transform_reduce_elements( 0., std::plus<>(), id, r ); } ),
+            r_bytes );
+    report( "sum padded", best_time( 10, [ & ] { sink += transform_reduce_elements( 0., std::plus<>(), id, p ); } ),
+            p_bytes );
+    report( "sum ragged parallel", best_time( 10, [ & ] {
+                sink += transform_reduce_elements( parallel_execution {}, 0., std::plus<>(), id, r );
+            } ),
+            r_bytes );
+    report( "scale ragged", best_time( 10, [ & ] { transform_elements( r, twice, r ); } ), 2 * r_bytes );
+    report( "scale padded", best_time( 10, [ & ] { transform_elements( p, twice, p ); } ), 2 * p_bytes );
+    report( "ragged to padded", best_time( 10, [ & ] { copy_to_padded( p, r, 0. ); } ), r_bytes + p_bytes );
+    report( "padded to ragged", best_time( 10, [ & ] { copy_from_padded( r, p ); } ), r_bytes + p_bytes );
+    std::printf( "checksum %g\n", sink );
+    return 0;
+}
@@ -0,0 +1,109 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/mdspan>
+#include <layout_contiguous.hpp>
+#include <stencil.hpp>
+#include <vector>
+
+#include "benchmark.hpp"
+
+using namespace std::experimental;
+
+namespace
+{
+
+void
+naive_laplacian( mdspan< double, dextents< int, 3 >, layout_stride > a,
+                 mdspan< const double, dextents< int, 3 >, layout_stride > b )
+{
+#pragma omp parallel for
+    for ( int i = 1; i < b.extent( 0 ) - 1; ++i )
+    {
+        for ( int j = 1; j < b.extent( 1 ) - 1; ++j )
+        {
+            for ( int k = 1; k < b.extent( 2 ) - 1; ++k )
+            {
+                a( i, j, k ) = -6. * b( i, j, k ) + ( b( i - 1, j, k ) + b( i + 1, j, k ) ) +
+                               ( b( i, j - 1, k ) + b( i, j + 1, k ) ) + ( b( i, j, k - 1 ) + b( i, j, k + 1 ) );
+            }
+        }
+    }
+}
+
+} // namespace
+
+int
+main( int argc, char** argv )
+{
+    int const n = argc > 1 ? std::atoi( argv[ 1 ] ) : 256;
+    int const n_sweeps = 8;
+    std::vector< double > a_data( std::size_t( n ) * n * n, 1. );
+    std::vector< double > b_data( a_data.size(), 1. );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > a( a_data.data(), n, n, n );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > b( b_data.data(), n, n, n );
+
+    stencil< double, stencil_point< 0, 0, 0 >, stencil_point< -1, 0, 0 >, stencil_point< 1, 0, 0 >,
+             stencil_point< 0, -1, 0 >, stencil_point< 0, 1, 0 >, stencil_point< 0, 0, -1 >,
+             stencil_point< 0, 0, 1 > > const laplacian( { -6., 1., 1., 1., 1., 1., 1. } );
+
+    // Compulsory traffic of one sweep: read b, write a. 7 multiplications and 6 additions per interior point.
+    double const bytes = 2. * sizeof( double ) * a_data.size();
+    double const flops = 13. * ( n - 2. ) * ( n - 2. ) * ( n - 2. );
+    std::printf( "%d^3 points, arithmetic intensity %.3f FLOP/B\n", n, flops / bytes );
+
+    double const t_copy = best_time( 5, [ & ] {
+#pragma omp parallel for
+        for ( std::size_t i = 0; i < a_data.size(); ++i )
+        {
+            a_data[ i ] = b_data[ i ];
+        }
+    } );
+    report( "copy (bandwidth roof)", t_copy, bytes );
+
+    mdspan< double, dextents< int, 3 >, layout_stride > a_stride( a.data_handle(), a.mapping() );
+    mdspan< const double, dextents< int, 3 >, layout_stride > b_stride( b.data_handle(), b.mapping() );
+    report( "naive layout_stride", best_time( 5, [ & ] { naive_laplacian( a_stride, b_stride ); } ), bytes, flops );
+
+    report( "apply_stencil sequential", best_time( 5, [ & ] { apply_stencil( a, b, laplacian ); } ), bytes, flops );
+    report( "apply_stencil parallel",
+            best_time( 5, [ & ] { apply_stencil( parallel_execution {}, a, b, laplacian ); } ), bytes, flops );
+    report( "apply_stencil parallel tiled 0x16x0",
+            best_time( 5, [ & ] { apply_stencil( parallel_execution {}, a, b, laplacian, { 0, 16, 0 } ); } ), bytes,
+            flops );
+
+    for ( int time_block : { 1, 2, 4, 8 } )
+    {
+        double const t = best_time( 3, [ & ] {
+            apply_stencil_sweeps( parallel_execution {}, a, b, laplacian, n_sweeps, time_block );
+        } );
+        char name[ 64 ];
+        std::snprintf( name, sizeof( name ), "sweeps parallel time_block=%d", time_block );
+        report( name, t / n_sweeps, bytes, flops );
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/mdspan>
+#include <fcntl.h>
+#include <iostream>
+#include <layout_contiguous.hpp>
+#include <memory.hpp>
+#include <string>
+#include <tile_stream.hpp>
+#include <unistd.h>
+
+#include "benchmark.hpp"
+
+using namespace std::experimental;
+
+namespace
+{
+
+/// Flushes the file and drops it from the page cache so that reads hit the storage
+void
+evict( std::string const& path )
+{
+    int const fd = ::open( path.c_str(), O_RDONLY );
+    if ( fd >= 0 )
+    {
+        ::fdatasync( fd );
+        ::posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+        ::close( fd );
+    }
+}
+
+/// Compute-bound stand-in for a real kernel, `n_iter` controlling the arithmetic intensity
+template < class In, class Out >
+void
+kernel( In const& in, Out const& out, int n_iter )
+{
+    for ( std::size_t i = 0; i < in.extent( 0 ); ++i )
+    {
+#pragma omp simd
+        for ( std::size_t j = 0; j < in.extent( 1 ); ++j )
+        {
+            double x = in( i, j );
+            for ( int it = 0; it < n_iter; ++it )
+            {
+                x = std::sqrt( x * x + 1. );
+            }
+            out( i, j ) = x;
+        }
+    }
+}
+
+} // namespace
+
+int
+main( int argc, char** argv )
+{
+    std::size_t const n_rows = argc > 1 ? std::atoi( argv[ 1 ] ) : 2048;
+    std::size_t const row_size = argc > 2 ? std::atoi( argv[ 2 ] ) : 1 << 15;
+    int const n_iter = argc > 3 ? std::atoi( argv[ 3 ] ) : 8;
+    std::string const dir = argc > 4 ? argv[ 4 ] : "/tmp";
+    std::string const src_path = dir + "/bench_tile_stream_src.bin";
+    std::string const dst_path = dir + "/bench_tile_stream_dst.bin";
+    std::array< std::size_t, 2 > const extents { n_rows, row_size };
+
+    tile_stream_config< 2 > config;
+    config.tile_extents = { 32, 0 };
+    config.queue_depth = 2;
+
+    {
+        file_array< double, 2 > const src( src_path, extents, file_mode::write );
+        aligned_vector< double > row( config.tile_extents[ 0 ] * row_size, 1. );
+        for ( std::size_t i = 0; i < n_rows; i += config.tile_extents[ 0 ] )
+        {
+            std::size_t const n = std::min( config.tile_extents[ 0 ], n_rows - i );
+            src.write( { i, 0 }, mdspan< double const, dextents< std::size_t, 2 > >( row.data(), n, row_size ) );
+        }
+    }
+    file_array< double, 2 > const src( src_path, extents, file_mode::read );
+    file_array< double, 2 > const dst( dst_path, extents, file_mode::write );
+    double const bytes = 2. * sizeof( double ) * n_rows * row_size;
+    std::printf( "%zu x %zu doubles (%.1f MB), slabs of %zu rows, queue depth %zu\n", n_rows, row_size,
+                 bytes * 0.5e-6, config.tile_extents[ 0 ], config.queue_depth );
+
+    // Reference: read, compute and write one slab after the other on the calling thread
+    evict( src_path );
+    evict( dst_path );
+    double const serial = best_time( 1, [ & ] {
+        aligned_vector< double > in_data( config.tile_extents[ 0 ] * row_size );
+        aligned_vector< double > out_data( in_data.size() );
+        for ( std::size_t i = 0; i < n_rows; i += config.tile_extents[ 0 ] )
+        {
+            std::size_t const n = std::min( config.tile_extents[ 0 ], n_rows - i );
+            mdspan< double, dextents< std::size_t, 2 > > const in( in_data.data(), n, row_size );
+            mdspan< double, dextents< std::size_t, 2 > > const out( out_data.data(), n, row_size );
+            src.read( { i, 0 }, in );
+            kernel( in, out, n_iter );
+            dst.write( { i, 0 }, out );
+        }
+    } );
+    report( "serial read/compute/write", serial, bytes );
+
+    evict( src_path );
+    evict( dst_path );
+    tile_stream_statistics stats;
+    double const pipelined = best_time( 1, [ & ] {
+        stats = stream_tiles( src, dst, config, [ & ]( auto const&, auto const& in, auto const& out ) {
+            kernel( in, out, n_iter );
+        } );
+    } );
+    report( "pipelined", pipelined, bytes );
+    stats.write_json( std::cout );
+
+    ::unlink( src_path.c_str() );
+    ::unlink( dst_path.c_str() );
+    return 0;
+}
@@ -0,0 +1,71 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <utility>
+
+/// Returns the best wall-clock time in seconds of `n_repeat` calls to `f`, after one warm-up call, `reset` being
+/// called untimed before each call to `f` to restore the inputs of in-place kernels
+template < class F, class Reset >
+double
+best_time( int n_repeat, F&& f, Reset&& reset )
+{
+    reset();
+    f();
+    double best = std::numeric_limits< double >::max();
+    for ( int r = 0; r < n_repeat; ++r )
+    {
+        reset();
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration< double > const elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min( best, elapsed.count() );
+    }
+    return best;
+}
+
+/// Returns the best wall-clock time in seconds of `n_repeat` calls to `f`, after one warm-up call
+template < class F >
+double
+best_time( int n_repeat, F&& f )
+{
+    return best_time( n_repeat, std::forward< F >( f ), [] {} );
+}
+
+/// Prints one result line: time, effective bandwidth for `bytes` moved and throughput for `flops` operations
+inline void
+report( char const* name, double seconds, double bytes, double flops = 0. )
+{
+    std::printf( "%-40s %12.3e s %10.2f GB/s", name, seconds, bytes / seconds * 1e-9 );
+    if ( flops > 0. )
+    {
+        std::printf( " %10.2f GFLOP/s", flops / seconds * 1e-9 );
+    }
+    std::printf( "\n" );
+}
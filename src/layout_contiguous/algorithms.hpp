@@ -0,0 +1,477 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "layout_ragged.hpp"
+#include "openmp.hpp"
+#include "traversal.hpp"
+
+namespace detail
+{
+
+template < class Mapping0, class Mapping >
+constexpr bool
+same_strides( Mapping0 const& m0, Mapping const& m ) noexcept
+{
+    for ( std::size_t d = 0; d < Mapping0::extents_type::rank(); ++d )
+    {
+        if ( m0.stride( d ) != m.stride( d ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template < class Mapping0, class Mapping >
+bool
+same_row_sizes( Mapping0 const& m0, Mapping const& m ) noexcept
+{
+    for ( typename Mapping0::index_type i = 0; i < m0.extents().extent( 0 ); ++i )
+    {
+        if ( m0.row_size( i ) != m.row_size( i ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Number of elements handled by a thread at once when a flat loop is shared among threads
+inline constexpr std::size_t linear_chunk_size = 4096;
+
+/// Dimension along which the runs of elements of `MDS` are contiguous
+template < class MDS >
+constexpr std::size_t
+run_dimension() noexcept
+{
+    if constexpr ( std::is_same_v< typename MDS::layout_type, layout_ragged_contiguous > )
+    {
+        return 1;
+    }
+    else
+    {
+        return contiguous_dimension< typename MDS::layout_type, MDS::rank() >::value;
+    }
+}
+
+/// Offset increment between consecutive elements of `x` along the dimension RunDim, a compile-time 1 when it is the
+/// contiguous dimension of `x`
+template < std::size_t RunDim, class MDS >
+constexpr auto
+run_increment( MDS const& x ) noexcept
+{
+    if constexpr ( run_dimension< MDS >() == RunDim )
+    {
+        return std::integral_constant< typename MDS::index_type, 1 >();
+    }
+    else
+    {
+        return x.mapping().stride( RunDim );
+    }
+}
+
+/// Box of runs visited in lexicographic order, the runs before it in the traversal being counted by `first_run`
+template < class IndexType, std::size_t Rank >
+struct run_leaf
+{
+    std::array< IndexType, Rank > lb;
+
+    std::array< IndexType, Rank > counts;
+
+    IndexType first_run;
+};
+
+/// Runs of elements of the views `x0, xs...`, which share the same extents, along the contiguous dimension of `x0`.
+/// Returns the number of runs and a function `visit( n, g )` calling `g( len, start0, starts... )` with the length of
+/// the n-th run and the offset of its first element in each view. The runs are visited in lexicographic order, or in
+/// Z-order by leaves of `leaf_size` indices in each dimension with a `morton_order` policy.
+template < class ExecutionPolicy, class MDS0, class... MDS >
+auto
+element_runs( ExecutionPolicy const& exec, MDS0 const& x0, MDS const&... xs )
+{
+    using index_type = typename MDS0::index_type;
+    constexpr index_type chunk = linear_chunk_size;
+    assert( ( ... && ( xs.extents() == x0.extents() ) ) );
+
+    if constexpr ( std::is_same_v< typename MDS0::layout_type, layout_ragged_contiguous > )
+    {
+        static_assert( ( ... && std::is_same_v< typename MDS::layout_type, layout_ragged_contiguous > ) );
+        assert( ( ... && same_row_sizes( x0.mapping(), xs.mapping() ) ) );
+
+        // Fast path: views sharing the same row offsets store their elements in the same flat range
+        index_type const n_rows = x0.extent( 0 );
+        bool const flat = ( ... && ( xs.mapping().row_offsets() == x0.mapping().row_offsets() ) );
+        index_type const first = n_rows == 0 ? 0 : x0.mapping().row_offset( 0 );
+        index_type const size = x0.mapping().size();
+        index_type const n_runs = flat ? ( size + chunk - 1 ) / chunk : n_rows;
+        auto visit = [ &x0, &xs..., chunk, flat, first, size ]( index_type n, auto&& g ) {
+            if ( flat )
+            {
+                index_type const start = first + n * chunk;
+                g( std::min( chunk, size - n * chunk ), start, ( (void)xs, start )... );
+            }
+            else
+            {
+                g( x0.mapping().row_size( n ), x0.mapping().row_offset( n ), xs.mapping().row_offset( n )... );
+            }
+        };
+        return std::make_pair( n_runs, visit );
+    }
+    else
+    {
+        constexpr std::size_t rank = MDS0::rank();
+        constexpr std::size_t cont = run_dimension< MDS0 >();
+
+        // Fast path: exhaustive views with the same strides share the same memory order
+        bool const flat = x0.mapping().is_exhaustive() && ( ... && same_strides( x0.mapping(), xs.mapping() ) );
+        index_type const size = x0.mapping().required_span_size();
+        std::array< index_type, rank > const lb {};
+        std::array< index_type, rank > ub;
+        for ( std::size_t d = 0; d < rank; ++d )
+        {
+            ub[ d ] = x0.extent( d );
+        }
+        index_type const len = ub[ cont ];
+        ub[ cont ] = len == 0 ? 0 : 1;
+
+        if constexpr ( !is_morton_order_v< ExecutionPolicy > )
+        {
+            std::array< index_type, rank > counts {};
+            index_type const n_runs = flat ? ( size + chunk - 1 ) / chunk : box_counts( lb, ub, counts );
+            auto visit = [ &x0, &xs..., chunk, flat, size, len, lb, counts ]( index_type n, auto&& g ) {
+                if ( flat )
+                {
+                    index_type const start = n * chunk;
+                    g( std::min( chunk, size - start ), start, ( (void)xs, start )... );
+                }
+                else
+                {
+                    std::array< index_type, rank > const idx = unravel< cont >( lb, counts, n );
+                    g( len, std::apply( x0.mapping(), idx ), std::apply( xs.mapping(), idx )... );
+                }
+            };
+            return std::make_pair( n_runs, visit );
+        }
+        else
+        {
+            std::vector< run_leaf< index_type, rank > > leaves;
+            index_type n_runs = 0;
+            if ( flat )
+            {
+                n_runs = ( size + chunk - 1 ) / chunk;
+            }
+            else
+            {
+                for_each_morton_leaf< cont >( lb, ub, index_type( morton_leaf_size( exec ) ),
+                                              [ & ]( std::array< index_type, rank > const& leaf_lb,
+                                                     std::array< index_type, rank > const& leaf_ub ) {
+                                                  run_leaf< index_type, rank > leaf { leaf_lb, {}, n_runs };
+                                                  n_runs += box_counts( leaf_lb, leaf_ub, leaf.counts );
+                                                  leaves.push_back( leaf );
+                                              } );
+            }
+            auto visit = [ &x0, &xs..., chunk, flat, size, len, leaves = std::move( leaves ) ]( index_type n,
+                                                                                                 auto&& g ) {
+                if ( flat )
+                {
+                    index_type const start = n * chunk;
+                    g( std::min( chunk, size - start ), start, ( (void)xs, start )... );
+                }
+                else
+                {
+                    auto const before = []( index_type m, run_leaf< index_type, rank > const& l ) {
+                        return m < l.first_run;
+                    };
+                    run_leaf< index_type, rank > const& leaf =
+                        *( std::upper_bound( leaves.begin(), leaves.end(), n, before ) - 1 );
+                    std::array< index_type, rank > const idx =
+                        unravel< cont >( leaf.lb, leaf.counts, n - leaf.first_run );
+                    g( len, std::apply( x0.mapping(), idx ), std::apply( xs.mapping(), idx )... );
+                }
+            };
+            return std::make_pair( n_runs, visit );
+        }
+    }
+}
+
+template < class ExecutionPolicy, class F, class MDS0, class... MDS >
+void
+for_each_element( ExecutionPolicy exec, F& f, MDS0 const& x0, MDS const&... xs )
+{
+    using index_type = typename MDS0::index_type;
+    constexpr std::size_t cont = run_dimension< MDS0 >();
+
+    auto const run = [ & ]( index_type len, index_type start0, auto... starts ) {
+        LAYOUT_CONTIGUOUS_SIMD
+        for ( index_type i = 0; i < len; ++i )
+        {
+            f( x0.accessor().access( x0.data_handle(), start0 + i ),
+               xs.accessor().access( xs.data_handle(), starts + i * run_increment< cont >( xs ) )... );
+        }
+    };
+
+    auto const runs = element_runs( exec, x0, xs... );
+    index_type const n_runs = runs.first;
+    if constexpr ( is_parallel_execution_v< ExecutionPolicy > )
+    {
+        LAYOUT_CONTIGUOUS_OMP( parallel for schedule( static ) )
+        for ( index_type n = 0; n < n_runs; ++n )
+        {
+            runs.second( n, run );
+        }
+    }
+    else
+    {
+        for ( index_type n = 0; n < n_runs; ++n )
+        {
+            runs.second( n, run );
+        }
+    }
+}
+
+/// Number of independent partial results within a run, to break the dependency chain of the reduction
+inline constexpr std::size_t reduction_lanes = 8;
+
+/// Number of consecutive groups of runs, in visit order, reduced independently, fixed so that the result does not
+/// depend on the number of threads
+inline constexpr std::size_t reduction_parts = 256;
+
+/// Reduction of the `len > 0` values `element( i )` of a run
+template < class T, class R, class Element, class IndexType >
+T
+reduce_run( R& reduce, Element const& element, IndexType len )
+{
+    constexpr IndexType lanes = reduction_lanes;
+    if ( len < lanes )
+    {
+        T acc = element( 0 );
+        for ( IndexType i = 1; i < len; ++i )
+        {
+            acc = reduce( acc, element( i ) );
+        }
+        return acc;
+    }
+
+    std::array< T, reduction_lanes > partial;
+    LAYOUT_CONTIGUOUS_SIMD
+    for ( IndexType k = 0; k < lanes; ++k )
+    {
+        partial[ k ] = element( k );
+    }
+    IndexType i = lanes;
+    for ( ; i + lanes <= len; i += lanes )
+    {
+        LAYOUT_CONTIGUOUS_SIMD
+        for ( IndexType k = 0; k < lanes; ++k )
+        {
+            partial[ k ] = reduce( partial[ k ], element( i + k ) );
+        }
+    }
+    for ( IndexType k = 0; i < len; ++i, ++k )
+    {
+        partial[ k ] = reduce( partial[ k ], element( i ) );
+    }
+    for ( IndexType width = lanes / 2; width > 0; width /= 2 )
+    {
+        for ( IndexType k = 0; k < width; ++k )
+        {
+            partial[ k ] = reduce( partial[ k ], partial[ k + width ] );
+        }
+    }
+    return partial[ 0 ];
+}
+
+template < class ExecutionPolicy, class T, class R, class F, class MDS0, class... MDS >
+T
+transform_reduce_elements( ExecutionPolicy exec, T init, R& reduce, F& transform, MDS0 const& x0, MDS const&... xs )
+{
+    using index_type = typename MDS0::index_type;
+    constexpr std::size_t cont = run_dimension< MDS0 >();
+
+    // Value of the i-th element of the run starting at offsets `start0, starts...`
+    auto const element_at = [ & ]( index_type start0, auto... starts ) {
+        return [ &, start0, starts... ]( index_type i ) -> T {
+            return transform( x0.accessor().access( x0.data_handle(), start0 + i ),
+                              xs.accessor().access( xs.data_handle(), starts + i * run_increment< cont >( xs ) )... );
+        };
+    };
+
+    auto const runs = element_runs( exec, x0, xs... );
+    index_type const n_runs = runs.first;
+    index_type const n_parts = std::min( index_type( reduction_parts ), n_runs );
+    std::vector< std::optional< T > > parts( n_parts );
+
+    auto const reduce_part = [ & ]( index_type p ) {
+        std::optional< T >& part = parts[ p ];
+        for ( index_type n = p * n_runs / n_parts; n < ( p + 1 ) * n_runs / n_parts; ++n )
+        {
+            runs.second( n, [ & ]( index_type len, auto... starts ) {
+                if ( len > 0 )
+                {
+                    T const r = reduce_run< T >( reduce, element_at( starts... ), len );
+                    part = part ? T( reduce( *part, r ) ) : r;
+                }
+            } );
+        }
+    };
+    if constexpr ( is_parallel_execution_v< ExecutionPolicy > )
+    {
+        LAYOUT_CONTIGUOUS_OMP( parallel for schedule( dynamic ) )
+        for ( index_type p = 0; p < n_parts; ++p )
+        {
+            reduce_part( p );
+        }
+    }
+    else
+    {
+        for ( index_type p = 0; p < n_parts; ++p )
+        {
+            reduce_part( p );
+        }
+    }
+
+    for ( std::optional< T > const& part : parts )
+    {
+        if ( part )
+        {
+            init = reduce( init, *part );
+        }
+    }
+    return init;
+}
+
+} // namespace detail
+
+/// Calls `f( x0( i... ), xs( i... )... )` for every multi-index `i...` of views sharing the same extents. The loop
+/// over the contiguous dimension of `x0` is vectorized, the views contiguous along another dimension being accessed
+/// with their stride, and, when all the views are exhaustive with the same strides, the elements are visited in a
+/// single flat loop over `required_span_size()` elements. The runs are visited in lexicographic order, or in Z-order
+/// with a `morton_order` policy.
+/// Ragged views (`layout_ragged_contiguous`) must share the same row sizes, the elements being visited row by row, or
+/// in a single flat loop when they share the same row offsets.
+/// As the body of an `omp simd` loop, `f` must not carry dependencies between elements.
+template < class ExecutionPolicy, class F, class MDS0, class... MDS,
+           std::enable_if_t< detail::is_execution_policy_v< ExecutionPolicy >, int > = 0 >
+void
+for_each_element( ExecutionPolicy exec, F&& f, MDS0 const& x0, MDS const&... xs )
+{
+    detail::for_each_element( exec, f, x0, xs... );
+}
+
+template < class F, class MDS0, class... MDS,
+           std::enable_if_t< !detail::is_execution_policy_v< std::decay_t< F > >, int > = 0 >
+void
+for_each_element( F&& f, MDS0 const& x0, MDS const&... xs )
+{
+    detail::for_each_element( sequential_execution {}, f, x0, xs... );
+}
+
+/// Computes `dst( i... ) = f( srcs( i... )... )` elementwise
+template < class ExecutionPolicy, class ET, class EP, class LP, class AP, class F, class... SrcMDS >
+void
+transform_elements( ExecutionPolicy exec, std::experimental::mdspan< ET, EP, LP, AP > const& dst, F&& f,
+                    SrcMDS const&... srcs )
+{
+    auto op = [ &f ]( auto&& d, auto&&... s ) { d = f( s... ); };
+    detail::for_each_element( exec, op, dst, srcs... );
+}
+
+template < class ET, class EP, class LP, class AP, class F, class... SrcMDS >
+void
+transform_elements( std::experimental::mdspan< ET, EP, LP, AP > const& dst, F&& f, SrcMDS const&... srcs )
+{
+    transform_elements( sequential_execution {}, dst, f, srcs... );
+}
+
+/// Copies `src` into `dst` elementwise
+template < class ExecutionPolicy, class DstET, class DstEP, class DstLP, class DstAP, class SrcET, class SrcEP,
+           class SrcLP, class SrcAP >
+void
+copy_elements( ExecutionPolicy exec, std::experimental::mdspan< DstET, DstEP, DstLP, DstAP > const& dst,
+               std::experimental::mdspan< SrcET, SrcEP, SrcLP, SrcAP > const& src )
+{
+    auto op = []( auto&& d, auto const& s ) { d = s; };
+    detail::for_each_element( exec, op, dst, src );
+}
+
+template < class DstET, class DstEP, class DstLP, class DstAP, class SrcET, class SrcEP, class SrcLP, class SrcAP >
+void
+copy_elements( std::experimental::mdspan< DstET, DstEP, DstLP, DstAP > const& dst,
+               std::experimental::mdspan< SrcET, SrcEP, SrcLP, SrcAP > const& src )
+{
+    copy_elements( sequential_execution {}, dst, src );
+}
+
+/// Assigns `value` to every element of `dst`
+template < class ExecutionPolicy, class ET, class EP, class LP, class AP, class T >
+void
+fill_elements( ExecutionPolicy exec, std::experimental::mdspan< ET, EP, LP, AP > const& dst, T const& value )
+{
+    auto op = [ &value ]( auto&& d ) { d = value; };
+    detail::for_each_element( exec, op, dst );
+}
+
+template < class ET, class EP, class LP, class AP, class T >
+void
+fill_elements( std::experimental::mdspan< ET, EP, LP, AP > const& dst, T const& value )
+{
+    fill_elements( sequential_execution {}, dst, value );
+}
+
+/// Returns `reduce( init, transform( x0( i... ), xs( i... )... ) )` accumulated over every multi-index `i...`, with the
+/// same requirements on the views as `for_each_element`. As in `std::transform_reduce`, `reduce` must be associative
+/// and commutative: the order of the accumulation is unspecified, but identical between `sequential_execution` and
+/// `parallel_execution`, and between `morton_order< sequential_execution >` and `morton_order< parallel_execution >`
+/// with the same leaf size. The Z-order groups the runs differently, so that floating-point results may differ in
+/// rounding from the lexicographic order.
+template < class ExecutionPolicy, class T, class R, class F, class MDS0, class... MDS,
+           std::enable_if_t< detail::is_execution_policy_v< ExecutionPolicy >, int > = 0 >
+T
+transform_reduce_elements( ExecutionPolicy exec, T init, R&& reduce, F&& transform, MDS0 const& x0,
+                           MDS const&... xs )
+{
+    return detail::transform_reduce_elements( exec, std::move( init ), reduce, transform, x0, xs... );
+}
+
+template < class T, class R, class F, class MDS0, class... MDS,
+           std::enable_if_t< !detail::is_execution_policy_v< T >, int > = 0 >
+T
+transform_reduce_elements( T init, R&& reduce, F&& transform, MDS0 const& x0, MDS const&... xs )
+{
+    return detail::transform_reduce_elements( sequential_execution {}, std::move( init ), reduce, transform, x0,
+                                              xs... );
+}
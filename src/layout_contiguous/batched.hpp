@@ -0,0 +1,611 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <type_traits>
+
+#include "layout_contiguous.hpp"
+#include "openmp.hpp"
+#include "traversal.hpp"
+
+// Batched kernels work on arrays of small vectors `x( b, i )` and small matrices `a( b, i, j )` stored with
+// `layout_contiguous_at_left`: the batch index `b` is contiguous and each SIMD lane handles one batch item.
+// The small extents must be static.
+
+namespace detail
+{
+
+/// Element `( b, i... )` of a batched view whose batch dimension has a unit stride
+template < class ElementType, std::size_t Rank >
+struct batch_ref
+{
+    ElementType* data;
+
+    std::array< std::ptrdiff_t, Rank > strides;
+
+    template < class... Indices >
+    MDSPAN_FORCE_INLINE_FUNCTION ElementType& operator()( std::ptrdiff_t b, Indices... indices ) const noexcept
+    {
+        static_assert( sizeof...( Indices ) + 1 == Rank );
+        return at( b, { std::ptrdiff_t( indices )... } );
+    }
+
+    MDSPAN_FORCE_INLINE_FUNCTION ElementType& at( std::ptrdiff_t b,
+                                                  std::array< std::ptrdiff_t, Rank - 1 > const& idx ) const noexcept
+    {
+        std::ptrdiff_t offset = b;
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t d = 1; d < Rank; ++d )
+        {
+            offset += idx[ d - 1 ] * strides[ d ];
+        }
+        return data[ offset ];
+    }
+};
+
+template < class ET, class EP, class AP >
+batch_ref< ET, EP::rank() >
+make_batch_ref( std::experimental::mdspan< ET, EP, layout_contiguous_at_left, AP > const& x ) noexcept
+{
+    static_assert( std::is_same_v< typename AP::data_handle_type, ET* > );
+    batch_ref< ET, EP::rank() > ref { x.data_handle(), {} };
+    for ( std::size_t d = 0; d < EP::rank(); ++d )
+    {
+        ref.strides[ d ] = x.mapping().stride( d );
+    }
+    return ref;
+}
+
+template < class Extents, std::size_t D >
+constexpr std::size_t
+small_extent() noexcept
+{
+    static_assert( Extents::static_extent( D ) != std::experimental::dynamic_extent,
+                   "The small dimensions of a batched view should be static" );
+    return Extents::static_extent( D );
+}
+
+/// Number of components of the small vectors or matrices of a batched view, 0 if a small extent is not static
+template < class Extents >
+constexpr std::size_t
+small_size() noexcept
+{
+    std::size_t size = 1;
+    for ( std::size_t d = 1; d < Extents::rank(); ++d )
+    {
+        if ( Extents::static_extent( d ) == std::experimental::dynamic_extent )
+        {
+            return 0;
+        }
+        size *= Extents::static_extent( d );
+    }
+    return size;
+}
+
+template < class Extents1, class Extents2 >
+constexpr bool
+same_small_extents() noexcept
+{
+    if constexpr ( Extents1::rank() != Extents2::rank() )
+    {
+        return false;
+    }
+    else
+    {
+        for ( std::size_t d = 1; d < Extents1::rank(); ++d )
+        {
+            if ( Extents1::static_extent( d ) != Extents2::static_extent( d ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/// Calls `f( idx )` for the multi-index `idx` of every component of a small vector or matrix, fully unrolled
+template < class Extents, class F >
+MDSPAN_FORCE_INLINE_FUNCTION void
+for_each_component( F const& f )
+{
+    constexpr std::size_t rank = Extents::rank();
+    constexpr std::size_t size = small_size< Extents >();
+    static_assert( rank > 1 && size > 0, "The small dimensions of a batched view should be static" );
+    LAYOUT_CONTIGUOUS_UNROLL
+    for ( std::size_t k = 0; k < size; ++k )
+    {
+        std::array< std::ptrdiff_t, rank - 1 > idx;
+        std::size_t rest = k;
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t d = 1; d < rank; ++d )
+        {
+            idx[ d - 1 ] = rest % Extents::static_extent( d );
+            rest /= Extents::static_extent( d );
+        }
+        f( idx );
+    }
+}
+
+template < class ExecutionPolicy, class IndexType, class F >
+void
+for_each_lane( ExecutionPolicy, IndexType n, F const& f )
+{
+    if constexpr ( is_parallel_execution_v< ExecutionPolicy > )
+    {
+        LAYOUT_CONTIGUOUS_OMP( parallel for simd schedule( static ) )
+        for ( IndexType b = 0; b < n; ++b )
+        {
+            f( b );
+        }
+    }
+    else
+    {
+        LAYOUT_CONTIGUOUS_SIMD
+        for ( IndexType b = 0; b < n; ++b )
+        {
+            f( b );
+        }
+    }
+}
+
+/// In-place LU factorization with partial pivoting, rows are swapped with selects so that lanes do not diverge
+template < std::size_t N, class T >
+MDSPAN_FORCE_INLINE_FUNCTION void
+small_lu( T ( &m )[ N ][ N ], int ( &piv )[ N ] ) noexcept
+{
+    LAYOUT_CONTIGUOUS_UNROLL
+    for ( std::size_t k = 0; k < N; ++k )
+    {
+        int p = int( k );
+        T pmax = std::abs( m[ k ][ k ] );
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = k + 1; i < N; ++i )
+        {
+            T const v = std::abs( m[ i ][ k ] );
+            p = v > pmax ? int( i ) : p;
+            pmax = v > pmax ? v : pmax;
+        }
+        piv[ k ] = p;
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = k + 1; i < N; ++i )
+        {
+            bool const swap = p == int( i );
+            LAYOUT_CONTIGUOUS_UNROLL
+            for ( std::size_t j = 0; j < N; ++j )
+            {
+                T const mk = m[ k ][ j ];
+                T const mi = m[ i ][ j ];
+                m[ k ][ j ] = swap ? mi : mk;
+                m[ i ][ j ] = swap ? mk : mi;
+            }
+        }
+        T const inv = T( 1 ) / m[ k ][ k ];
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = k + 1; i < N; ++i )
+        {
+            m[ i ][ k ] *= inv;
+            LAYOUT_CONTIGUOUS_UNROLL
+            for ( std::size_t j = k + 1; j < N; ++j )
+            {
+                m[ i ][ j ] -= m[ i ][ k ] * m[ k ][ j ];
+            }
+        }
+    }
+}
+
+/// Solves in place `lu x = rhs` given the output of `small_lu`
+template < std::size_t N, class T, class U >
+MDSPAN_FORCE_INLINE_FUNCTION void
+small_lu_solve( T const ( &lu )[ N ][ N ], int const ( &piv )[ N ], U ( &x )[ N ] ) noexcept
+{
+    LAYOUT_CONTIGUOUS_UNROLL
+    for ( std::size_t k = 0; k < N; ++k )
+    {
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = k + 1; i < N; ++i )
+        {
+            bool const swap = piv[ k ] == int( i );
+            U const xk = x[ k ];
+            U const xi = x[ i ];
+            x[ k ] = swap ? xi : xk;
+            x[ i ] = swap ? xk : xi;
+        }
+    }
+    LAYOUT_CONTIGUOUS_UNROLL
+    for ( std::size_t i = 1; i < N; ++i )
+    {
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t j = 0; j < i; ++j )
+        {
+            x[ i ] -= lu[ i ][ j ] * x[ j ];
+        }
+    }
+    LAYOUT_CONTIGUOUS_UNROLL
+    for ( std::size_t r = 0; r < N; ++r )
+    {
+        std::size_t const i = N - 1 - r;
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t j = i + 1; j < N; ++j )
+        {
+            x[ i ] -= lu[ i ][ j ] * x[ j ];
+        }
+        x[ i ] /= lu[ i ][ i ];
+    }
+}
+
+template < std::size_t N, class T, class Ref >
+MDSPAN_FORCE_INLINE_FUNCTION void
+load_matrix( T ( &m )[ N ][ N ], Ref const& a, std::ptrdiff_t b ) noexcept
+{
+    LAYOUT_CONTIGUOUS_UNROLL
+    for ( std::size_t i = 0; i < N; ++i )
+    {
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t j = 0; j < N; ++j )
+        {
+            m[ i ][ j ] = a( b, i, j );
+        }
+    }
+}
+
+} // namespace detail
+
+/// y( b, i ) = sum_j a( b, i, j ) * x( b, j )
+template < class ExecutionPolicy, class YET, class YEP, class YAP, class AET, class AEP, class AAP, class XET,
+           class XEP, class XAP >
+void
+batched_matvec( ExecutionPolicy exec, std::experimental::mdspan< YET, YEP, layout_contiguous_at_left, YAP > const& y,
+                std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a,
+                std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x )
+{
+    constexpr std::size_t m = detail::small_extent< AEP, 1 >();
+    constexpr std::size_t n = detail::small_extent< AEP, 2 >();
+    static_assert( detail::small_extent< YEP, 1 >() == m && detail::small_extent< XEP, 1 >() == n );
+    assert( y.extent( 0 ) == a.extent( 0 ) && x.extent( 0 ) == a.extent( 0 ) );
+    auto const yr = detail::make_batch_ref( y );
+    auto const ar = detail::make_batch_ref( a );
+    auto const xr = detail::make_batch_ref( x );
+    detail::for_each_lane( exec, a.extent( 0 ), [ = ]( std::ptrdiff_t b ) {
+        std::remove_cv_t< XET > xb[ n ];
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t j = 0; j < n; ++j )
+        {
+            xb[ j ] = xr( b, j );
+        }
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = 0; i < m; ++i )
+        {
+            std::remove_cv_t< YET > sum = 0;
+            LAYOUT_CONTIGUOUS_UNROLL
+            for ( std::size_t j = 0; j < n; ++j )
+            {
+                sum += ar( b, i, j ) * xb[ j ];
+            }
+            yr( b, i ) = sum;
+        }
+    } );
+}
+
+template < class YET, class YEP, class YAP, class AET, class AEP, class AAP, class XET, class XEP, class XAP >
+void
+batched_matvec( std::experimental::mdspan< YET, YEP, layout_contiguous_at_left, YAP > const& y,
+                std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a,
+                std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x )
+{
+    batched_matvec( sequential_execution {}, y, a, x );
+}
+
+/// r( b ) = sum_i x( b, i ) * y( b, i )
+template < class ExecutionPolicy, class RET, class REP, class RAP, class XET, class XEP, class XAP, class YET,
+           class YEP, class YAP >
+void
+batched_dot( ExecutionPolicy exec, std::experimental::mdspan< RET, REP, layout_contiguous_at_left, RAP > const& r,
+             std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x,
+             std::experimental::mdspan< YET, YEP, layout_contiguous_at_left, YAP > const& y )
+{
+    constexpr std::size_t n = detail::small_extent< XEP, 1 >();
+    static_assert( REP::rank() == 1 && detail::small_extent< YEP, 1 >() == n );
+    assert( r.extent( 0 ) == x.extent( 0 ) && y.extent( 0 ) == x.extent( 0 ) );
+    auto const rr = detail::make_batch_ref( r );
+    auto const xr = detail::make_batch_ref( x );
+    auto const yr = detail::make_batch_ref( y );
+    detail::for_each_lane( exec, x.extent( 0 ), [ = ]( std::ptrdiff_t b ) {
+        std::remove_cv_t< RET > sum = 0;
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            sum += xr( b, i ) * yr( b, i );
+        }
+        rr( b ) = sum;
+    } );
+}
+
+template < class RET, class REP, class RAP, class XET, class XEP, class XAP, class YET, class YEP, class YAP >
+void
+batched_dot( std::experimental::mdspan< RET, REP, layout_contiguous_at_left, RAP > const& r,
+             std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x,
+             std::experimental::mdspan< YET, YEP, layout_contiguous_at_left, YAP > const& y )
+{
+    batched_dot( sequential_execution {}, r, x, y );
+}
+
+/// x( b, i... ) *= alpha( b ) for every component of the small vectors or matrices `x( b, ... )`
+template < class ExecutionPolicy, class XET, class XEP, class XAP, class AET, class AEP, class AAP >
+void
+batched_scale( ExecutionPolicy exec, std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x,
+               std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& alpha )
+{
+    static_assert( AEP::rank() == 1 );
+    assert( alpha.extent( 0 ) == x.extent( 0 ) );
+    auto const xr = detail::make_batch_ref( x );
+    auto const ar = detail::make_batch_ref( alpha );
+    detail::for_each_lane( exec, x.extent( 0 ), [ = ]( std::ptrdiff_t b ) {
+        std::remove_cv_t< AET > const ab = ar( b );
+        detail::for_each_component< XEP >(
+            [ & ]( std::array< std::ptrdiff_t, XEP::rank() - 1 > const& idx ) { xr.at( b, idx ) *= ab; } );
+    } );
+}
+
+template < class XET, class XEP, class XAP, class AET, class AEP, class AAP >
+void
+batched_scale( std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x,
+               std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& alpha )
+{
+    batched_scale( sequential_execution {}, x, alpha );
+}
+
+/// y( b, i... ) += alpha( b ) * x( b, i... ) for every component of the small vectors or matrices `y( b, ... )`
+template < class ExecutionPolicy, class YET, class YEP, class YAP, class AET, class AEP, class AAP, class XET,
+           class XEP, class XAP >
+void
+batched_axpy( ExecutionPolicy exec, std::experimental::mdspan< YET, YEP, layout_contiguous_at_left, YAP > const& y,
+              std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& alpha,
+              std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x )
+{
+    static_assert( AEP::rank() == 1 && detail::same_small_extents< YEP, XEP >() );
+    assert( alpha.extent( 0 ) == y.extent( 0 ) && x.extent( 0 ) == y.extent( 0 ) );
+    auto const yr = detail::make_batch_ref( y );
+    auto const ar = detail::make_batch_ref( alpha );
+    auto const xr = detail::make_batch_ref( x );
+    detail::for_each_lane( exec, y.extent( 0 ), [ = ]( std::ptrdiff_t b ) {
+        std::remove_cv_t< AET > const ab = ar( b );
+        detail::for_each_component< YEP >( [ & ]( std::array< std::ptrdiff_t, YEP::rank() - 1 > const& idx ) {
+            yr.at( b, idx ) += ab * xr.at( b, idx );
+        } );
+    } );
+}
+
+template < class YET, class YEP, class YAP, class AET, class AEP, class AAP, class XET, class XEP, class XAP >
+void
+batched_axpy( std::experimental::mdspan< YET, YEP, layout_contiguous_at_left, YAP > const& y,
+              std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& alpha,
+              std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x )
+{
+    batched_axpy( sequential_execution {}, y, alpha, x );
+}
+
+/// In-place LU factorization with partial pivoting of every matrix `a( b, :, : )`, the row swapped with row `k` at
+/// step `k` is stored in `piv( b, k )`. Singular matrices are not detected.
+template < class ExecutionPolicy, class AET, class AEP, class AAP, class PEP, class PAP >
+void
+batched_lu( ExecutionPolicy exec, std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a,
+            std::experimental::mdspan< int, PEP, layout_contiguous_at_left, PAP > const& piv )
+{
+    constexpr std::size_t n = detail::small_extent< AEP, 1 >();
+    static_assert( detail::small_extent< AEP, 2 >() == n && detail::small_extent< PEP, 1 >() == n );
+    assert( piv.extent( 0 ) == a.extent( 0 ) );
+    auto const ar = detail::make_batch_ref( a );
+    auto const pr = detail::make_batch_ref( piv );
+    detail::for_each_lane( exec, a.extent( 0 ), [ = ]( std::ptrdiff_t b ) {
+        AET m[ n ][ n ];
+        int p[ n ];
+        detail::load_matrix( m, ar, b );
+        detail::small_lu( m, p );
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            pr( b, i ) = p[ i ];
+            LAYOUT_CONTIGUOUS_UNROLL
+            for ( std::size_t j = 0; j < n; ++j )
+            {
+                ar( b, i, j ) = m[ i ][ j ];
+            }
+        }
+    } );
+}
+
+template < class AET, class AEP, class AAP, class PEP, class PAP >
+void
+batched_lu( std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a,
+            std::experimental::mdspan< int, PEP, layout_contiguous_at_left, PAP > const& piv )
+{
+    batched_lu( sequential_execution {}, a, piv );
+}
+
+/// Solves in place `lu( b ) x( b ) = rhs( b )` given the output of `batched_lu`
+template < class ExecutionPolicy, class AET, class AEP, class AAP, class PET, class PEP, class PAP, class XET,
+           class XEP, class XAP >
+void
+batched_lu_solve( ExecutionPolicy exec, std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& lu,
+                  std::experimental::mdspan< PET, PEP, layout_contiguous_at_left, PAP > const& piv,
+                  std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x )
+{
+    constexpr std::size_t n = detail::small_extent< AEP, 1 >();
+    static_assert( detail::small_extent< PEP, 1 >() == n && detail::small_extent< XEP, 1 >() == n );
+    assert( piv.extent( 0 ) == lu.extent( 0 ) && x.extent( 0 ) == lu.extent( 0 ) );
+    auto const ar = detail::make_batch_ref( lu );
+    auto const pr = detail::make_batch_ref( piv );
+    auto const xr = detail::make_batch_ref( x );
+    detail::for_each_lane( exec, lu.extent( 0 ), [ = ]( std::ptrdiff_t b ) {
+        std::remove_cv_t< AET > m[ n ][ n ];
+        int p[ n ];
+        XET xb[ n ];
+        detail::load_matrix( m, ar, b );
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            p[ i ] = pr( b, i );
+            xb[ i ] = xr( b, i );
+        }
+        detail::small_lu_solve( m, p, xb );
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            xr( b, i ) = xb[ i ];
+        }
+    } );
+}
+
+template < class AET, class AEP, class AAP, class PET, class PEP, class PAP, class XET, class XEP, class XAP >
+void
+batched_lu_solve( std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& lu,
+                  std::experimental::mdspan< PET, PEP, layout_contiguous_at_left, PAP > const& piv,
+                  std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x )
+{
+    batched_lu_solve( sequential_execution {}, lu, piv, x );
+}
+
+/// Solves in place `a( b ) x( b ) = rhs( b )`, the factorization of `a` is kept in registers and not stored
+template < class ExecutionPolicy, class AET, class AEP, class AAP, class XET, class XEP, class XAP >
+void
+batched_solve( ExecutionPolicy exec, std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a,
+               std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x )
+{
+    constexpr std::size_t n = detail::small_extent< AEP, 1 >();
+    static_assert( detail::small_extent< AEP, 2 >() == n && detail::small_extent< XEP, 1 >() == n );
+    assert( x.extent( 0 ) == a.extent( 0 ) );
+    auto const ar = detail::make_batch_ref( a );
+    auto const xr = detail::make_batch_ref( x );
+    detail::for_each_lane( exec, a.extent( 0 ), [ = ]( std::ptrdiff_t b ) {
+        std::remove_cv_t< AET > m[ n ][ n ];
+        int p[ n ];
+        XET xb[ n ];
+        detail::load_matrix( m, ar, b );
+        detail::small_lu( m, p );
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            xb[ i ] = xr( b, i );
+        }
+        detail::small_lu_solve( m, p, xb );
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            xr( b, i ) = xb[ i ];
+        }
+    } );
+}
+
+template < class AET, class AEP, class AAP, class XET, class XEP, class XAP >
+void
+batched_solve( std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a,
+               std::experimental::mdspan< XET, XEP, layout_contiguous_at_left, XAP > const& x )
+{
+    batched_solve( sequential_execution {}, a, x );
+}
+
+/// det( b ) = determinant of a( b, :, : )
+template < class ExecutionPolicy, class DET, class DEP, class DAP, class AET, class AEP, class AAP >
+void
+batched_determinant( ExecutionPolicy exec,
+                     std::experimental::mdspan< DET, DEP, layout_contiguous_at_left, DAP > const& det,
+                     std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a )
+{
+    constexpr std::size_t n = detail::small_extent< AEP, 1 >();
+    static_assert( DEP::rank() == 1 && detail::small_extent< AEP, 2 >() == n );
+    assert( det.extent( 0 ) == a.extent( 0 ) );
+    auto const dr = detail::make_batch_ref( det );
+    auto const ar = detail::make_batch_ref( a );
+    detail::for_each_lane( exec, a.extent( 0 ), [ = ]( std::ptrdiff_t b ) {
+        std::remove_cv_t< AET > m[ n ][ n ];
+        int p[ n ];
+        detail::load_matrix( m, ar, b );
+        detail::small_lu( m, p );
+        std::remove_cv_t< DET > d = 1;
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t k = 0; k < n; ++k )
+        {
+            d *= p[ k ] == int( k ) ? m[ k ][ k ] : -m[ k ][ k ];
+        }
+        dr( b ) = d;
+    } );
+}
+
+template < class DET, class DEP, class DAP, class AET, class AEP, class AAP >
+void
+batched_determinant( std::experimental::mdspan< DET, DEP, layout_contiguous_at_left, DAP > const& det,
+                     std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a )
+{
+    batched_determinant( sequential_execution {}, det, a );
+}
+
+/// inv( b, :, : ) = inverse of a( b, :, : )
+template < class ExecutionPolicy, class IET, class IEP, class IAP, class AET, class AEP, class AAP >
+void
+batched_inverse( ExecutionPolicy exec, std::experimental::mdspan< IET, IEP, layout_contiguous_at_left, IAP > const& inv,
+                 std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a )
+{
+    constexpr std::size_t n = detail::small_extent< AEP, 1 >();
+    static_assert( detail::small_extent< AEP, 2 >() == n && detail::small_extent< IEP, 1 >() == n &&
+                   detail::small_extent< IEP, 2 >() == n );
+    assert( inv.extent( 0 ) == a.extent( 0 ) );
+    auto const ir = detail::make_batch_ref( inv );
+    auto const ar = detail::make_batch_ref( a );
+    detail::for_each_lane( exec, a.extent( 0 ), [ = ]( std::ptrdiff_t b ) {
+        std::remove_cv_t< AET > m[ n ][ n ];
+        int p[ n ];
+        detail::load_matrix( m, ar, b );
+        detail::small_lu( m, p );
+        LAYOUT_CONTIGUOUS_UNROLL
+        for ( std::size_t j = 0; j < n; ++j )
+        {
+            IET col[ n ];
+            LAYOUT_CONTIGUOUS_UNROLL
+            for ( std::size_t i = 0; i < n; ++i )
+            {
+                col[ i ] = i == j ? 1 : 0;
+            }
+            detail::small_lu_solve( m, p, col );
+            LAYOUT_CONTIGUOUS_UNROLL
+            for ( std::size_t i = 0; i < n; ++i )
+            {
+                ir( b, i, j ) = col[ i ];
+            }
+        }
+    } );
+}
+
+template < class IET, class IEP, class IAP, class AET, class AEP, class AAP >
+void
+batched_inverse( std::experimental::mdspan< IET, IEP, layout_contiguous_at_left, IAP > const& inv,
+                 std::experimental::mdspan< AET, AEP, layout_contiguous_at_left, AAP > const& a )
+{
+    batched_inverse( sequential_execution {}, inv, a );
+}
@@ -0,0 +1,355 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <experimental/mdspan>
+#include <type_traits>
+
+#include "algorithms.hpp"
+#include "traversal.hpp"
+
+namespace detail
+{
+
+template < class To, class From >
+MDSPAN_FORCE_INLINE_FUNCTION To
+bit_cast( From const& x ) noexcept
+{
+    static_assert( sizeof( To ) == sizeof( From ) );
+    To y;
+    std::memcpy( &y, &x, sizeof( To ) );
+    return y;
+}
+
+/// Round to nearest even, NaNs being kept quiet
+MDSPAN_FORCE_INLINE_FUNCTION std::uint16_t
+float_to_bfloat16_bits( float x ) noexcept
+{
+    std::uint32_t const u = bit_cast< std::uint32_t >( x );
+    std::uint32_t const rounded = ( u + 0x7fffu + ( ( u >> 16 ) & 1u ) ) >> 16;
+    bool const is_nan = ( u & 0x7fffffffu ) > 0x7f800000u;
+    return std::uint16_t( is_nan ? ( u >> 16 ) | 0x40u : rounded );
+}
+
+MDSPAN_FORCE_INLINE_FUNCTION float
+bfloat16_bits_to_float( std::uint16_t h ) noexcept
+{
+    return bit_cast< float >( std::uint32_t( h ) << 16 );
+}
+
+/// Round to nearest even, overflows giving infinities and NaNs being kept quiet. The branches select between values
+/// computed on all the paths so that the conversion vectorizes.
+MDSPAN_FORCE_INLINE_FUNCTION std::uint16_t
+float_to_float16_bits( float x ) noexcept
+{
+    constexpr std::uint32_t f32_infinity = 255u << 23;
+    constexpr std::uint32_t f16_overflow = ( 127u + 16u ) << 23;
+    constexpr std::uint32_t f16_min_normal = 113u << 23;
+    constexpr std::uint32_t subnormal_magic = ( ( 127u - 15u ) + ( 23u - 10u ) + 1u ) << 23;
+
+    std::uint32_t const u = bit_cast< std::uint32_t >( x );
+    std::uint32_t const sign = u & 0x80000000u;
+    std::uint32_t const a = u ^ sign;
+
+    // Subnormal results: the addition aligns the mantissa and rounds it with the current rounding mode
+    std::uint32_t const subnormal =
+        bit_cast< std::uint32_t >( bit_cast< float >( a ) + bit_cast< float >( subnormal_magic ) ) - subnormal_magic;
+    std::uint32_t const normal = ( a + ( ( 15u - 127u ) << 23 ) + 0xfffu + ( ( a >> 13 ) & 1u ) ) >> 13;
+    std::uint32_t const special = a > f32_infinity ? 0x7e00u : 0x7c00u;
+    std::uint32_t const h = a >= f16_overflow ? special : a < f16_min_normal ? subnormal : normal;
+    return std::uint16_t( h | ( sign >> 16 ) );
+}
+
+MDSPAN_FORCE_INLINE_FUNCTION float
+float16_bits_to_float( std::uint16_t h ) noexcept
+{
+    constexpr std::uint32_t shifted_exponent = 0x7c00u << 13;
+    constexpr float subnormal_magic = 0x1p-14f;
+
+    std::uint32_t const magnitude = ( std::uint32_t( h ) & 0x7fffu ) << 13;
+    std::uint32_t const exponent = magnitude & shifted_exponent;
+    std::uint32_t const normal = magnitude + ( ( 127u - 15u ) << 23 );
+    std::uint32_t const special = normal + ( ( 128u - 16u ) << 23 );
+    std::uint32_t const subnormal = bit_cast< std::uint32_t >( bit_cast< float >( normal + ( 1u << 23 ) ) -
+                                                               subnormal_magic );
+    std::uint32_t const f = exponent == shifted_exponent ? special : exponent == 0 ? subnormal : normal;
+    return bit_cast< float >( f | ( ( std::uint32_t( h ) & 0x8000u ) << 16 ) );
+}
+
+/// Rounds to float with round-to-odd: truncation, the last bit being set if inexact. A second rounding to a format
+/// with at least 2 bits less of precision then gives the same result as a direct rounding.
+MDSPAN_FORCE_INLINE_FUNCTION float
+round_to_odd( double x ) noexcept
+{
+    float const nearest = static_cast< float >( x );
+    std::uint32_t const u = bit_cast< std::uint32_t >( nearest );
+    // Steps back toward zero if the rounding went away from zero
+    std::uint32_t const truncated = std::fabs( double( nearest ) ) > std::fabs( x ) ? u - 1 : u;
+    return bit_cast< float >( double( nearest ) != x ? truncated | 1u : truncated );
+}
+
+} // namespace detail
+
+/// Brain floating-point format: 8 bits of exponent as `float` and 8 bits of precision, converted in software
+class bfloat16
+{
+public:
+    bfloat16() noexcept = default;
+
+    /// Rounds to nearest even
+    explicit bfloat16( float x ) noexcept : m_bits( detail::float_to_bfloat16_bits( x ) )
+    {
+    }
+
+    /// Rounds to nearest even, without double rounding through `float`
+    explicit bfloat16( double x ) noexcept : m_bits( detail::float_to_bfloat16_bits( detail::round_to_odd( x ) ) )
+    {
+    }
+
+    static bfloat16 from_bits( std::uint16_t bits ) noexcept
+    {
+        bfloat16 x;
+        x.m_bits = bits;
+        return x;
+    }
+
+    std::uint16_t bits() const noexcept
+    {
+        return m_bits;
+    }
+
+    /// Exact
+    operator float() const noexcept
+    {
+        return detail::bfloat16_bits_to_float( m_bits );
+    }
+
+private:
+    std::uint16_t m_bits;
+};
+
+/// IEEE 754 binary16 format: 5 bits of exponent and 11 bits of precision, converted in software
+class float16
+{
+public:
+    float16() noexcept = default;
+
+    /// Rounds to nearest even
+    explicit float16( float x ) noexcept : m_bits( detail::float_to_float16_bits( x ) )
+    {
+    }
+
+    /// Rounds to nearest even, without double rounding through `float`
+    explicit float16( double x ) noexcept : m_bits( detail::float_to_float16_bits( detail::round_to_odd( x ) ) )
+    {
+    }
+
+    static float16 from_bits( std::uint16_t bits ) noexcept
+    {
+        float16 x;
+        x.m_bits = bits;
+        return x;
+    }
+
+    std::uint16_t bits() const noexcept
+    {
+        return m_bits;
+    }
+
+    /// Exact
+    operator float() const noexcept
+    {
+        return detail::float16_bits_to_float( m_bits );
+    }
+
+private:
+    std::uint16_t m_bits;
+};
+
+/// Rounding of the conversions to a narrower floating-point type
+enum class rounding_mode
+{
+    to_nearest_even,
+    toward_zero,
+    upward,
+    downward
+};
+
+namespace detail
+{
+
+template < class T >
+inline constexpr bool is_convertible_floating_point_v = std::is_same_v< T, double > || std::is_same_v< T, float > ||
+                                                         std::is_same_v< T, bfloat16 > || std::is_same_v< T, float16 >;
+
+/// Number of bits of precision
+template < class T >
+inline constexpr int precision_v = std::is_same_v< T, double >  ? 53
+                                   : std::is_same_v< T, float > ? 24
+                                   : std::is_same_v< T, float16 > ? 11
+                                                                  : 8;
+
+/// Whether every `From` value is exactly representable as a `To`
+template < class To, class From >
+inline constexpr bool is_widening_v = std::is_same_v< To, From > || std::is_same_v< To, double > ||
+                                      ( std::is_same_v< To, float > && precision_v< From > < 24 );
+
+template < class To, class From >
+MDSPAN_FORCE_INLINE_FUNCTION To
+round_to_nearest( From x ) noexcept
+{
+    if constexpr ( std::is_same_v< To, From > )
+    {
+        return x;
+    }
+    else if constexpr ( std::is_same_v< To, double > || std::is_same_v< To, float > )
+    {
+        if constexpr ( std::is_same_v< From, double > || std::is_same_v< From, float > )
+        {
+            return static_cast< To >( x );
+        }
+        else
+        {
+            return static_cast< To >( static_cast< float >( x ) );
+        }
+    }
+    else if constexpr ( std::is_same_v< From, double > || std::is_same_v< From, float > )
+    {
+        return To( x );
+    }
+    else
+    {
+        return To( static_cast< float >( x ) );
+    }
+}
+
+/// Adds `delta` to the magnitude of `x` in units in the last place, the representation being sign-magnitude
+template < class T >
+MDSPAN_FORCE_INLINE_FUNCTION T
+add_ulps( T x, std::int32_t delta ) noexcept
+{
+    if constexpr ( std::is_same_v< T, float > )
+    {
+        return bit_cast< float >( bit_cast< std::uint32_t >( x ) + std::uint32_t( delta ) );
+    }
+    else
+    {
+        return T::from_bits( std::uint16_t( x.bits() + std::uint32_t( delta ) ) );
+    }
+}
+
+/// Next representable value toward +infinity if `up`, toward -infinity otherwise, `x` being finite or 0
+template < class T >
+MDSPAN_FORCE_INLINE_FUNCTION T
+step( T x, bool up ) noexcept
+{
+    bool const negative = std::signbit( static_cast< float >( x ) );
+    return add_ulps( x, up != negative ? 1 : -1 );
+}
+
+/// Converts `x` with the rounding mode Mode: the value rounded to nearest is moved by one step when it lies on the
+/// wrong side of `x`
+template < class To, rounding_mode Mode, class From >
+MDSPAN_FORCE_INLINE_FUNCTION To
+convert_element( From x ) noexcept
+{
+    To const nearest = round_to_nearest< To >( x );
+    if constexpr ( Mode == rounding_mode::to_nearest_even || is_widening_v< To, From > )
+    {
+        return nearest;
+    }
+    else
+    {
+        // Both are exactly representable in the comparison type
+        using compare_type = std::conditional_t< std::is_same_v< From, double >, double, float >;
+        compare_type const exact = static_cast< compare_type >( x );
+        compare_type const rounded = static_cast< compare_type >( static_cast< float >( nearest ) );
+        if constexpr ( Mode == rounding_mode::toward_zero )
+        {
+            bool const away = std::fabs( rounded ) > std::fabs( exact );
+            return add_ulps( nearest, away ? -1 : 0 );
+        }
+        else if constexpr ( Mode == rounding_mode::upward )
+        {
+            return rounded < exact ? step( nearest, true ) : nearest;
+        }
+        else
+        {
+            return rounded > exact ? step( nearest, false ) : nearest;
+        }
+    }
+}
+
+template < rounding_mode Mode, class ExecutionPolicy, class DstSpan, class SrcSpan >
+void
+convert_copy( ExecutionPolicy exec, DstSpan const& dst, SrcSpan const& src )
+{
+    using dst_type = typename DstSpan::value_type;
+    auto op = []( auto&& d, auto const& s ) { d = convert_element< dst_type, Mode >( s ); };
+    for_each_element( exec, op, dst, src );
+}
+
+} // namespace detail
+
+/// Copies `src` into `dst` converting between `double`, `float`, `bfloat16` and `float16`, the narrowing conversions
+/// being rounded with `mode`. The views may have different contiguous dimensions, see `for_each_element`, and the
+/// conversions vectorize along the contiguous dimension of `dst`.
+template < class ExecutionPolicy, class DstET, class DstEP, class DstLP, class DstAP, class SrcET, class SrcEP,
+           class SrcLP, class SrcAP, std::enable_if_t< detail::is_execution_policy_v< ExecutionPolicy >, int > = 0 >
+void
+convert_copy( ExecutionPolicy exec, std::experimental::mdspan< DstET, DstEP, DstLP, DstAP > const& dst,
+              std::experimental::mdspan< SrcET, SrcEP, SrcLP, SrcAP > const& src,
+              rounding_mode mode = rounding_mode::to_nearest_even )
+{
+    static_assert( detail::is_convertible_floating_point_v< std::remove_cv_t< DstET > > );
+    static_assert( detail::is_convertible_floating_point_v< std::remove_cv_t< SrcET > > );
+    switch ( mode )
+    {
+    case rounding_mode::to_nearest_even:
+        detail::convert_copy< rounding_mode::to_nearest_even >( exec, dst, src );
+        break;
+    case rounding_mode::toward_zero:
+        detail::convert_copy< rounding_mode::toward_zero >( exec, dst, src );
+        break;
+    case rounding_mode::upward:
+        detail::convert_copy< rounding_mode::upward >( exec, dst, src );
+        break;
+    case rounding_mode::downward:
+        detail::convert_copy< rounding_mode::downward >( exec, dst, src );
+        break;
+    }
+}
+
+template < class DstET, class DstEP, class DstLP, class DstAP, class SrcET, class SrcEP, class SrcLP, class SrcAP >
+void
+convert_copy( std::experimental::mdspan< DstET, DstEP, DstLP, DstAP > const& dst,
+              std::experimental::mdspan< SrcET, SrcEP, SrcLP, SrcAP > const& src,
+              rounding_mode mode = rounding_mode::to_nearest_even )
+{
+    convert_copy( sequential_execution {}, dst, src, mode );
+}
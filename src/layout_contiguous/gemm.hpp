@@ -0,0 +1,259 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <type_traits>
+
+#include "algorithms.hpp"
+#include "layout_contiguous.hpp"
+#include "memory.hpp"
+#include "openmp.hpp"
+#include "traversal.hpp"
+
+/// Cache blocking of `gemm`: blocks of `mc x kc` elements of A and panels of `kc x nc` elements of B are packed
+struct gemm_blocking
+{
+    std::size_t mc = 96;
+
+    std::size_t kc = 256;
+
+    std::size_t nc = 4092;
+};
+
+namespace detail
+{
+
+/// Size of the block of C kept in registers by the micro-kernel, a column of the tile spans a cache line
+template < class T >
+struct gemm_micro_tile
+{
+    static constexpr std::size_t mr = sizeof( T ) < 64 ? 64 / sizeof( T ) : 1;
+
+    static constexpr std::size_t nr = 6;
+};
+
+/// Packs A[i0:i0+mc, k0:k0+kc] in panels of `MR` rows stored column by column, the last panel being padded with zeros
+template < std::size_t MR, class T, class AMDS >
+void
+gemm_pack_a( T* packed, AMDS const& a, std::size_t i0, std::size_t mc, std::size_t k0, std::size_t kc )
+{
+    std::ptrdiff_t const s0 = a.mapping().stride( 0 );
+    std::ptrdiff_t const s1 = a.mapping().stride( 1 );
+    for ( std::size_t p = 0; p < mc; p += MR )
+    {
+        std::size_t const m = std::min( MR, mc - p );
+        auto const* const panel = a.data_handle() + std::ptrdiff_t( i0 + p ) * s0 + std::ptrdiff_t( k0 ) * s1;
+        for ( std::size_t k = 0; k < kc; ++k )
+        {
+            for ( std::size_t r = 0; r < m; ++r )
+            {
+                packed[ r ] = panel[ std::ptrdiff_t( r ) * s0 + std::ptrdiff_t( k ) * s1 ];
+            }
+            for ( std::size_t r = m; r < MR; ++r )
+            {
+                packed[ r ] = T( 0 );
+            }
+            packed += MR;
+        }
+    }
+}
+
+/// Packs the panel B[k0:k0+kc, j0:j0+NR] row by row, padded with zeros beyond column `n`
+template < std::size_t NR, class T, class BMDS >
+void
+gemm_pack_b( T* packed, BMDS const& b, std::size_t k0, std::size_t kc, std::size_t j0, std::size_t n )
+{
+    std::ptrdiff_t const s0 = b.mapping().stride( 0 );
+    std::ptrdiff_t const s1 = b.mapping().stride( 1 );
+    auto const* const panel = b.data_handle() + std::ptrdiff_t( k0 ) * s0 + std::ptrdiff_t( j0 ) * s1;
+    for ( std::size_t k = 0; k < kc; ++k )
+    {
+        for ( std::size_t c = 0; c < n; ++c )
+        {
+            packed[ c ] = panel[ std::ptrdiff_t( k ) * s0 + std::ptrdiff_t( c ) * s1 ];
+        }
+        for ( std::size_t c = n; c < NR; ++c )
+        {
+            packed[ c ] = T( 0 );
+        }
+        packed += NR;
+    }
+}
+
+/// Accumulates the product of a packed panel of A and a packed panel of B in a register block
+template < std::size_t MR, std::size_t NR, class T >
+MDSPAN_FORCE_INLINE_FUNCTION void
+gemm_micro_kernel( std::size_t kc, T const* a, T const* b, T ( &acc )[ NR ][ MR ] )
+{
+    for ( std::size_t k = 0; k < kc; ++k )
+    {
+        for ( std::size_t c = 0; c < NR; ++c )
+        {
+            T const bkc = b[ c ];
+            LAYOUT_CONTIGUOUS_SIMD
+            for ( std::size_t r = 0; r < MR; ++r )
+            {
+                acc[ c ][ r ] += a[ r ] * bkc;
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+}
+
+/// C[i0:i0+mc, j0:j0+nc] += alpha * packed A * packed B
+template < std::size_t MR, std::size_t NR, class T, class CMDS >
+void
+gemm_macro_kernel( T alpha, T const* a_packed, T const* b_packed, CMDS const& c, std::size_t i0, std::size_t mc,
+                   std::size_t j0, std::size_t nc, std::size_t kc )
+{
+    std::ptrdiff_t const s0 = c.mapping().stride( 0 );
+    std::ptrdiff_t const s1 = c.mapping().stride( 1 );
+    for ( std::size_t jr = 0; jr < nc; jr += NR )
+    {
+        std::size_t const n = std::min( NR, nc - jr );
+        for ( std::size_t ir = 0; ir < mc; ir += MR )
+        {
+            std::size_t const m = std::min( MR, mc - ir );
+            alignas( 64 ) T acc[ NR ][ MR ] = {};
+            gemm_micro_kernel< MR, NR >( kc, a_packed + ir * kc, b_packed + jr * kc, acc );
+            T* const tile = c.data_handle() + std::ptrdiff_t( i0 + ir ) * s0 + std::ptrdiff_t( j0 + jr ) * s1;
+            for ( std::size_t cc = 0; cc < n; ++cc )
+            {
+                for ( std::size_t r = 0; r < m; ++r )
+                {
+                    tile[ std::ptrdiff_t( r ) * s0 + std::ptrdiff_t( cc ) * s1 ] += alpha * acc[ cc ][ r ];
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+/// Computes C = alpha * A * B + beta * C for rank-2 `layout_contiguous_at_*` views of any combination of layouts,
+/// the leading dimensions being read from the strides so that subviews can be used without copy.
+/// Blocks of A and B are packed in aligned buffers and multiplied by a register-blocked vectorized micro-kernel.
+/// With `parallel_execution`, the blocks of rows of C are shared among OpenMP threads.
+template < class ExecutionPolicy, class CET, class CEP, class CLP, class CAP, class AET, class AEP, class ALP,
+           class AAP, class BET, class BEP, class BLP, class BAP,
+           std::enable_if_t< detail::is_execution_policy_v< ExecutionPolicy >, int > = 0 >
+void
+gemm( ExecutionPolicy exec, std::remove_cv_t< CET > alpha, std::experimental::mdspan< AET, AEP, ALP, AAP > const& a,
+      std::experimental::mdspan< BET, BEP, BLP, BAP > const& b, std::remove_cv_t< CET > beta,
+      std::experimental::mdspan< CET, CEP, CLP, CAP > const& c, gemm_blocking const& blocking = {} )
+{
+    using T = std::remove_cv_t< CET >;
+    constexpr std::size_t mr = detail::gemm_micro_tile< T >::mr;
+    constexpr std::size_t nr = detail::gemm_micro_tile< T >::nr;
+    static_assert( AEP::rank() == 2 && BEP::rank() == 2 && CEP::rank() == 2 );
+    static_assert( detail::is_layout_contiguous_v< ALP > && detail::is_layout_contiguous_v< BLP > &&
+                   detail::is_layout_contiguous_v< CLP > );
+    assert( c.extent( 0 ) == a.extent( 0 ) && c.extent( 1 ) == b.extent( 1 ) && a.extent( 1 ) == b.extent( 0 ) );
+
+    std::size_t const m = c.extent( 0 );
+    std::size_t const n = c.extent( 1 );
+    std::size_t const k = a.extent( 1 );
+
+    if ( beta == T( 0 ) )
+    {
+        fill_elements( exec, c, T( 0 ) );
+    }
+    else if ( beta != T( 1 ) )
+    {
+        transform_elements( exec, c, [ beta ]( T x ) { return beta * x; }, c );
+    }
+    if ( m == 0 || n == 0 || k == 0 || alpha == T( 0 ) )
+    {
+        return;
+    }
+
+    std::size_t const mc = ( std::max( blocking.mc, mr ) + mr - 1 ) / mr * mr;
+    std::size_t const nc = ( std::max( blocking.nc, nr ) + nr - 1 ) / nr * nr;
+    std::size_t const kc = std::max( blocking.kc, std::size_t( 1 ) );
+    aligned_vector< T > b_packed( std::min( kc, k ) * std::min( nc, ( n + nr - 1 ) / nr * nr ) );
+
+    for ( std::size_t jc = 0; jc < n; jc += nc )
+    {
+        std::size_t const ncur = std::min( nc, n - jc );
+        std::ptrdiff_t const n_panels = ( ncur + nr - 1 ) / nr;
+        for ( std::size_t pc = 0; pc < k; pc += kc )
+        {
+            std::size_t const kcur = std::min( kc, k - pc );
+            std::ptrdiff_t const n_blocks = ( m + mc - 1 ) / mc;
+            auto const block = [ & ]( T* a_packed, std::ptrdiff_t ib ) {
+                std::size_t const ic = ib * mc;
+                std::size_t const mcur = std::min( mc, m - ic );
+                detail::gemm_pack_a< mr >( a_packed, a, ic, mcur, pc, kcur );
+                detail::gemm_macro_kernel< mr, nr >( alpha, a_packed, b_packed.data(), c, ic, mcur, jc, ncur, kcur );
+            };
+            if constexpr ( detail::is_parallel_execution_v< ExecutionPolicy > )
+            {
+                LAYOUT_CONTIGUOUS_OMP( parallel )
+                {
+                    LAYOUT_CONTIGUOUS_OMP( for schedule( static ) )
+                    for ( std::ptrdiff_t q = 0; q < n_panels; ++q )
+                    {
+                        detail::gemm_pack_b< nr >( b_packed.data() + q * nr * kcur, b, pc, kcur, jc + q * nr,
+                                                   std::min( nr, ncur - q * nr ) );
+                    }
+                    aligned_vector< T > a_packed( std::min( mc, ( m + mr - 1 ) / mr * mr ) * kcur );
+                    LAYOUT_CONTIGUOUS_OMP( for schedule( dynamic ) )
+                    for ( std::ptrdiff_t ib = 0; ib < n_blocks; ++ib )
+                    {
+                        block( a_packed.data(), ib );
+                    }
+                }
+            }
+            else
+            {
+                for ( std::ptrdiff_t q = 0; q < n_panels; ++q )
+                {
+                    detail::gemm_pack_b< nr >( b_packed.data() + q * nr * kcur, b, pc, kcur, jc + q * nr,
+                                               std::min( nr, ncur - q * nr ) );
+                }
+                aligned_vector< T > a_packed( std::min( mc, ( m + mr - 1 ) / mr * mr ) * kcur );
+                for ( std::ptrdiff_t ib = 0; ib < n_blocks; ++ib )
+                {
+                    block( a_packed.data(), ib );
+                }
+            }
+        }
+    }
+}
+
+template < class CET, class CEP, class CLP, class CAP, class AET, class AEP, class ALP, class AAP, class BET, class BEP,
+           class BLP, class BAP >
+void
+gemm( std::remove_cv_t< CET > alpha, std::experimental::mdspan< AET, AEP, ALP, AAP > const& a,
+      std::experimental::mdspan< BET, BEP, BLP, BAP > const& b, std::remove_cv_t< CET > beta,
+      std::experimental::mdspan< CET, CEP, CLP, CAP > const& c, gemm_blocking const& blocking = {} )
+{
+    gemm( sequential_execution {}, alpha, a, b, beta, c, blocking );
+}
@@ -28,6 +28,7 @@
 #include <cstdint>
 #include <experimental/mdspan>
 #include <stdexcept>
+#include <type_traits>
 
 #include "mapping_contiguous.hpp"
 
@@ -246,3 +247,12 @@ submdspan( std::experimental::mdspan< ET, EP, layout_contiguous_at_right, AP > c
         return mdspan< ET, SubEP, layout_contiguous_at_right, AP >( s );
     }
 }
+
+namespace detail
+{
+
+template < class Layout >
+inline constexpr bool is_layout_contiguous_v =
+    std::is_same_v< Layout, layout_contiguous_at_left > || std::is_same_v< Layout, layout_contiguous_at_right >;
+
+} // namespace detail
@@ -0,0 +1,318 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "layout_contiguous.hpp"
+#include "openmp.hpp"
+#include "traversal.hpp"
+
+/// Layout of a rank-2 ragged array: row `i` stores its `row_size( i )` elements contiguously from offset
+/// `row_offsets[ i ]` (CSR-style). The second extent bounds the row sizes, only the indices `( i, j )` with
+/// `j < row_size( i )` are valid. The row offsets are referenced, not copied, and must outlive the mapping.
+struct layout_ragged_contiguous
+{
+    template < class Extents >
+    class mapping
+    {
+        static_assert( Extents::rank() == 2 );
+
+    public:
+        using extents_type = Extents;
+        using index_type = typename extents_type::index_type;
+        using size_type = typename extents_type::size_type;
+        using rank_type = typename extents_type::rank_type;
+        using layout_type = layout_ragged_contiguous;
+
+        constexpr mapping() noexcept = default;
+
+        constexpr mapping( mapping const& ) noexcept = default;
+
+        /// `row_offsets` holds `extents.extent( 0 ) + 1` nondecreasing offsets
+        mapping( Extents const& extents, index_type const* row_offsets )
+            : m_extents( extents )
+            , m_row_offsets( row_offsets )
+        {
+            for ( index_type i = 0; i < m_extents.extent( 0 ); ++i )
+            {
+                if ( m_row_offsets[ i + 1 ] < m_row_offsets[ i ] )
+                {
+                    throw std::runtime_error( "The row offsets should be nondecreasing" );
+                }
+                if ( m_row_offsets[ i + 1 ] - m_row_offsets[ i ] > m_extents.extent( 1 ) )
+                {
+                    throw std::runtime_error( "The rows should fit in the extents" );
+                }
+            }
+        }
+
+        template < class OtherExtents >
+        constexpr mapping( mapping< OtherExtents > const& rhs ) noexcept
+            : m_extents( rhs.extents() )
+            , m_row_offsets( rhs.row_offsets() )
+        {
+        }
+
+        constexpr mapping& operator=( mapping const& ) noexcept = default;
+
+        constexpr Extents const& extents() const noexcept
+        {
+            return m_extents;
+        }
+
+        constexpr index_type const* row_offsets() const noexcept
+        {
+            return m_row_offsets;
+        }
+
+        constexpr index_type row_offset( index_type i ) const noexcept
+        {
+            assert( i <= m_extents.extent( 0 ) );
+            return m_row_offsets[ i ];
+        }
+
+        constexpr index_type row_size( index_type i ) const noexcept
+        {
+            assert( i < m_extents.extent( 0 ) );
+            return m_row_offsets[ i + 1 ] - m_row_offsets[ i ];
+        }
+
+        /// Number of elements stored, i.e. the sum of the row sizes
+        constexpr index_type size() const noexcept
+        {
+            return m_row_offsets ? m_row_offsets[ m_extents.extent( 0 ) ] - m_row_offsets[ 0 ] : 0;
+        }
+
+        constexpr index_type required_span_size() const noexcept
+        {
+            return m_row_offsets ? m_row_offsets[ m_extents.extent( 0 ) ] : 0;
+        }
+
+        template < class I0, class I1 >
+        MDSPAN_FORCE_INLINE_FUNCTION constexpr index_type operator()( I0 i, I1 j ) const noexcept
+        {
+            assert( index_type( j ) < row_size( i ) );
+            return m_row_offsets[ i ] + j;
+        }
+
+        /// Over the rectangular domain of the extents, the mapping is neither unique, exhaustive nor strided
+        static constexpr bool is_always_unique() noexcept
+        {
+            return false;
+        }
+
+        static constexpr bool is_always_exhaustive() noexcept
+        {
+            return false;
+        }
+
+        static constexpr bool is_always_strided() noexcept
+        {
+            return false;
+        }
+
+        constexpr bool is_unique() const noexcept
+        {
+            return false;
+        }
+
+        constexpr bool is_exhaustive() const noexcept
+        {
+            return false;
+        }
+
+        constexpr bool is_strided() const noexcept
+        {
+            return false;
+        }
+
+        template < class OtherExtents >
+        friend constexpr bool operator==( mapping const& lhs, mapping< OtherExtents > const& rhs ) noexcept
+        {
+            return lhs.extents() == rhs.extents() && lhs.row_offsets() == rhs.row_offsets();
+        }
+
+    private:
+        Extents m_extents = Extents( std::array< index_type, Extents::rank_dynamic() > {} );
+
+        index_type const* m_row_offsets = nullptr;
+    };
+};
+
+/// Exclusive scan of the row sizes in [first, last) into the `n_rows + 1` row offsets of a ragged layout
+template < class InputIt >
+std::vector< typename std::iterator_traits< InputIt >::value_type >
+ragged_row_offsets( InputIt first, InputIt last )
+{
+    using index_type = typename std::iterator_traits< InputIt >::value_type;
+    std::vector< index_type > row_offsets( 1, index_type( 0 ) );
+    row_offsets.reserve( std::distance( first, last ) + 1 );
+    for ( ; first != last; ++first )
+    {
+        row_offsets.push_back( row_offsets.back() + *first );
+    }
+    return row_offsets;
+}
+
+/// Smallest extents of a ragged layout described by `n_rows + 1` row offsets
+template < class IndexType >
+std::experimental::dextents< IndexType, 2 >
+ragged_extents( IndexType const* row_offsets, IndexType n_rows )
+{
+    IndexType max_row_size = 0;
+    for ( IndexType i = 0; i < n_rows; ++i )
+    {
+        max_row_size = std::max( max_row_size, IndexType( row_offsets[ i + 1 ] - row_offsets[ i ] ) );
+    }
+    return std::experimental::dextents< IndexType, 2 >( n_rows, max_row_size );
+}
+
+/// Row `i` of a ragged view as a 1D contiguous view of `row_size( i )` elements
+template < class ET, class EP, class AP >
+std::experimental::mdspan< ET, std::experimental::dextents< typename EP::index_type, 1 >, layout_contiguous_at_right,
+                           typename AP::offset_policy >
+ragged_row( std::experimental::mdspan< ET, EP, layout_ragged_contiguous, AP > const& x, typename EP::index_type i )
+{
+    using row_extents = std::experimental::dextents< typename EP::index_type, 1 >;
+    using row_mapping = layout_contiguous_at_right::mapping< row_extents >;
+    return std::experimental::mdspan< ET, row_extents, layout_contiguous_at_right, typename AP::offset_policy >(
+        x.accessor().offset( x.data_handle(), x.mapping().row_offset( i ) ),
+        row_mapping( row_extents( x.mapping().row_size( i ) ) ), typename AP::offset_policy( x.accessor() ) );
+}
+
+/// All the elements of a ragged view as a 1D contiguous view, row after row
+template < class ET, class EP, class AP >
+std::experimental::mdspan< ET, std::experimental::dextents< typename EP::index_type, 1 >, layout_contiguous_at_right,
+                           typename AP::offset_policy >
+ragged_values( std::experimental::mdspan< ET, EP, layout_ragged_contiguous, AP > const& x )
+{
+    using values_extents = std::experimental::dextents< typename EP::index_type, 1 >;
+    using values_mapping = layout_contiguous_at_right::mapping< values_extents >;
+    typename EP::index_type const first = x.extent( 0 ) == 0 ? 0 : x.mapping().row_offset( 0 );
+    return std::experimental::mdspan< ET, values_extents, layout_contiguous_at_right, typename AP::offset_policy >(
+        x.accessor().offset( x.data_handle(), first ), values_mapping( values_extents( x.mapping().size() ) ),
+        typename AP::offset_policy( x.accessor() ) );
+}
+
+namespace detail
+{
+
+template < class ExecutionPolicy, class RaggedSpan, class PaddedSpan, class F >
+void
+for_each_padded_row( ExecutionPolicy, RaggedSpan const& ragged, PaddedSpan const& padded, F&& f )
+{
+    using index_type = typename RaggedSpan::index_type;
+    assert( ragged.extents() == padded.extents() );
+    index_type const n_rows = ragged.extent( 0 );
+    if constexpr ( is_parallel_execution_v< ExecutionPolicy > )
+    {
+        LAYOUT_CONTIGUOUS_OMP( parallel for schedule( dynamic, 16 ) )
+        for ( index_type i = 0; i < n_rows; ++i )
+        {
+            f( i );
+        }
+    }
+    else
+    {
+        for ( index_type i = 0; i < n_rows; ++i )
+        {
+            f( i );
+        }
+    }
+}
+
+} // namespace detail
+
+/// Copies the first `row_size( i )` elements of every row `i` of the rectangular view `src` into the ragged view `dst`
+template < class ExecutionPolicy, class DstET, class DstEP, class DstAP, class SrcET, class SrcEP, class SrcLP,
+           class SrcAP >
+void
+copy_from_padded( ExecutionPolicy exec,
+                  std::experimental::mdspan< DstET, DstEP, layout_ragged_contiguous, DstAP > const& dst,
+                  std::experimental::mdspan< SrcET, SrcEP, SrcLP, SrcAP > const& src )
+{
+    using index_type = typename DstEP::index_type;
+    detail::for_each_padded_row( exec, dst, src, [ & ]( index_type i ) {
+        index_type const len = dst.mapping().row_size( i );
+        index_type const start = dst.mapping().row_offset( i );
+        LAYOUT_CONTIGUOUS_SIMD
+        for ( index_type j = 0; j < len; ++j )
+        {
+            dst.accessor().access( dst.data_handle(), start + j ) =
+                src.accessor().access( src.data_handle(), src.mapping()( i, j ) );
+        }
+    } );
+}
+
+template < class DstET, class DstEP, class DstAP, class SrcET, class SrcEP, class SrcLP, class SrcAP >
+void
+copy_from_padded( std::experimental::mdspan< DstET, DstEP, layout_ragged_contiguous, DstAP > const& dst,
+                  std::experimental::mdspan< SrcET, SrcEP, SrcLP, SrcAP > const& src )
+{
+    copy_from_padded( sequential_execution {}, dst, src );
+}
+
+/// Copies the ragged view `src` into the rectangular view `dst` of the same extents, the elements of `dst` past the
+/// end of each row being set to `pad`
+template < class ExecutionPolicy, class DstET, class DstEP, class DstLP, class DstAP, class SrcET, class SrcEP,
+           class SrcAP, class T >
+void
+copy_to_padded( ExecutionPolicy exec, std::experimental::mdspan< DstET, DstEP, DstLP, DstAP > const& dst,
+                std::experimental::mdspan< SrcET, SrcEP, layout_ragged_contiguous, SrcAP > const& src, T const& pad )
+{
+    using index_type = typename SrcEP::index_type;
+    detail::for_each_padded_row( exec, src, dst, [ & ]( index_type i ) {
+        index_type const len = src.mapping().row_size( i );
+        index_type const start = src.mapping().row_offset( i );
+        index_type const n_cols = dst.extent( 1 );
+        LAYOUT_CONTIGUOUS_SIMD
+        for ( index_type j = 0; j < len; ++j )
+        {
+            dst.accessor().access( dst.data_handle(), dst.mapping()( i, j ) ) =
+                src.accessor().access( src.data_handle(), start + j );
+        }
+        LAYOUT_CONTIGUOUS_SIMD
+        for ( index_type j = len; j < n_cols; ++j )
+        {
+            dst.accessor().access( dst.data_handle(), dst.mapping()( i, j ) ) = pad;
+        }
+    } );
+}
+
+template < class DstET, class DstEP, class DstLP, class DstAP, class SrcET, class SrcEP, class SrcAP, class T >
+void
+copy_to_padded( std::experimental::mdspan< DstET, DstEP, DstLP, DstAP > const& dst,
+                std::experimental::mdspan< SrcET, SrcEP, layout_ragged_contiguous, SrcAP > const& src, T const& pad )
+{
+    copy_to_padded( sequential_execution {}, dst, src, pad );
+}
@@ -0,0 +1,103 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <experimental/mdspan>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace detail
+{
+
+template < class Extents, std::size_t... Is >
+constexpr std::size_t
+static_size( std::index_sequence< Is... > ) noexcept
+{
+    if constexpr ( Extents::rank_dynamic() != 0 )
+    {
+        return std::experimental::dynamic_extent;
+    }
+    else
+    {
+        return ( std::size_t( 1 ) * ... * Extents::static_extent( Is ) );
+    }
+}
+
+/// Extents of the linear view of an exhaustive mapping, static if all the extents are static
+template < class Extents >
+using linear_extents_t =
+    std::experimental::extents< typename Extents::index_type,
+                                static_size< Extents >( std::make_index_sequence< Extents::rank() >() ) >;
+
+template < class ET, class EP, class LP, class AP >
+constexpr std::experimental::mdspan< ET, linear_extents_t< EP >, std::experimental::layout_right, AP >
+linear_span( std::experimental::mdspan< ET, EP, LP, AP > const& x )
+{
+    using linear_extents = linear_extents_t< EP >;
+    using linear_mapping = std::experimental::layout_right::mapping< linear_extents >;
+    using linear_span_type = std::experimental::mdspan< ET, linear_extents, std::experimental::layout_right, AP >;
+    if constexpr ( linear_extents::rank_dynamic() == 0 )
+    {
+        return linear_span_type( x.data_handle(), linear_mapping( linear_extents() ), x.accessor() );
+    }
+    else
+    {
+        return linear_span_type( x.data_handle(),
+                                 linear_mapping( linear_extents( x.mapping().required_span_size() ) ), x.accessor() );
+    }
+}
+
+} // namespace detail
+
+/// Views an exhaustive `x` as a 1D contiguous range of `required_span_size()` elements in memory order.
+/// The check is done at compile-time for always exhaustive mappings, otherwise throws if `x` is not exhaustive.
+template < class ET, class EP, class LP, class AP >
+constexpr std::experimental::mdspan< ET, detail::linear_extents_t< EP >, std::experimental::layout_right, AP >
+as_linear_span( std::experimental::mdspan< ET, EP, LP, AP > const& x )
+{
+    if constexpr ( !LP::template mapping< EP >::is_always_exhaustive() )
+    {
+        if ( !x.mapping().is_exhaustive() )
+        {
+            throw std::runtime_error( "The mapping is not exhaustive" );
+        }
+    }
+    return detail::linear_span( x );
+}
+
+/// Same as `as_linear_span` but returns an empty optional if `x` is not exhaustive
+template < class ET, class EP, class LP, class AP >
+constexpr std::optional<
+    std::experimental::mdspan< ET, detail::linear_extents_t< EP >, std::experimental::layout_right, AP > >
+try_as_linear_span( std::experimental::mdspan< ET, EP, LP, AP > const& x )
+{
+    if ( !x.mapping().is_exhaustive() )
+    {
+        return std::nullopt;
+    }
+    return detail::linear_span( x );
+}
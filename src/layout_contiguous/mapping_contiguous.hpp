@@ -95,6 +95,12 @@ protected:
     constexpr mapping_contiguous_at& operator=( mapping_contiguous_at&& ) noexcept = default;
 
 public:
+    /// Rank index of the dimension with compile-time unit stride
+    static constexpr rank_type contiguous_index() noexcept
+    {
+        return ContIdx;
+    }
+
     constexpr Extents const& extents() const noexcept
     {
         return m_extents;
@@ -107,6 +113,10 @@ public:
 
     constexpr index_type required_span_size() const noexcept
     {
+        if ( ( ... || ( m_extents.extent( Is ) == 0 ) ) )
+        {
+            return 0;
+        }
         return ( 1 + ... + ( ( m_extents.extent( Is ) - 1 ) * stride< Is >() ) );
     }
 
@@ -124,9 +134,10 @@ public:
         return true;
     }
 
+    /// Only the contiguous dimension can have an extent different from 1
     static constexpr bool is_always_exhaustive() noexcept
     {
-        return false;
+        return ( ... && ( Is == ContIdx || Extents::static_extent( Is ) == 1 ) );
     }
 
     static constexpr bool is_always_strided() noexcept
@@ -139,24 +150,10 @@ public:
         return true;
     }
 
-    bool is_exhaustive() const noexcept
+    /// The mapping being unique, it is exhaustive if and only if its span has no more elements than its extents
+    constexpr bool is_exhaustive() const noexcept
     {
-        std::array< index_type, Extents::rank() > rem { Is... };
-        std::sort( rem.begin(), rem.end(),
-                   [ this ]( index_type i1, index_type i2 ) { return m_strides[ i1 ] < m_strides[ i2 ]; } );
-        index_type a = 1;
-        for ( index_type i : rem )
-        {
-            if ( m_strides[ i ] <= a )
-            {
-                a += m_strides[ i ] * ( m_extents.extent( i ) - 1 );
-            }
-            else
-            {
-                return false;
-            }
-        }
-        return true;
+        return required_span_size() == ( index_type( 1 ) * ... * m_extents.extent( Is ) );
     }
 
     constexpr bool is_strided() const noexcept
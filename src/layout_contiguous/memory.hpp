@@ -0,0 +1,77 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/// Allocator returning memory aligned on `Alignment` bytes, e.g. a cache line or a SIMD register
+template < class T, std::size_t Alignment = 64 >
+class aligned_allocator
+{
+    static_assert( Alignment >= alignof( T ) && ( Alignment & ( Alignment - 1 ) ) == 0 );
+
+public:
+    using value_type = T;
+
+    template < class U >
+    struct rebind
+    {
+        using other = aligned_allocator< U, Alignment >;
+    };
+
+    constexpr aligned_allocator() noexcept = default;
+
+    template < class U >
+    constexpr aligned_allocator( aligned_allocator< U, Alignment > const& ) noexcept
+    {
+    }
+
+    T* allocate( std::size_t n )
+    {
+        return static_cast< T* >( ::operator new( n * sizeof( T ), std::align_val_t( Alignment ) ) );
+    }
+
+    void deallocate( T* p, std::size_t ) noexcept
+    {
+        ::operator delete( p, std::align_val_t( Alignment ) );
+    }
+
+    template < class U >
+    friend constexpr bool operator==( aligned_allocator const&, aligned_allocator< U, Alignment > const& ) noexcept
+    {
+        return true;
+    }
+
+    template < class U >
+    friend constexpr bool operator!=( aligned_allocator const&, aligned_allocator< U, Alignment > const& ) noexcept
+    {
+        return false;
+    }
+};
+
+template < class T, std::size_t Alignment = 64 >
+using aligned_vector = std::vector< T, aligned_allocator< T, Alignment > >;
@@ -0,0 +1,56 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+// OpenMP directives are only emitted when OpenMP is enabled, so that the headers compile without unknown pragma
+// warnings otherwise, the parallel execution policies then running sequentially.
+#define LAYOUT_CONTIGUOUS_PRAGMA( ... ) _Pragma( #__VA_ARGS__ )
+
+#if defined( _OPENMP )
+#define LAYOUT_CONTIGUOUS_OMP( ... ) LAYOUT_CONTIGUOUS_PRAGMA( omp __VA_ARGS__ )
+#else
+#define LAYOUT_CONTIGUOUS_OMP( ... )
+#endif
+
+// Loops without dependencies between iterations, vectorized with `omp simd` or the compiler-specific equivalent.
+// `-fopenmp-simd` does not define `_OPENMP`: define `LAYOUT_CONTIGUOUS_OPENMP_SIMD` to keep `omp simd` in that case.
+#if defined( _OPENMP ) || defined( LAYOUT_CONTIGUOUS_OPENMP_SIMD )
+#define LAYOUT_CONTIGUOUS_SIMD _Pragma( "omp simd" )
+#elif defined( __clang__ )
+#define LAYOUT_CONTIGUOUS_SIMD _Pragma( "clang loop vectorize( assume_safety )" )
+#elif defined( __GNUG__ )
+#define LAYOUT_CONTIGUOUS_SIMD _Pragma( "GCC ivdep" )
+#else
+#define LAYOUT_CONTIGUOUS_SIMD
+#endif
+
+// Loops over small static extents, fully unrolled so that an enclosing loop can be vectorized
+#if defined( __clang__ )
+#define LAYOUT_CONTIGUOUS_UNROLL _Pragma( "unroll" )
+#elif defined( __GNUG__ )
+#define LAYOUT_CONTIGUOUS_UNROLL _Pragma( "GCC unroll 16" )
+#else
+#define LAYOUT_CONTIGUOUS_UNROLL
+#endif
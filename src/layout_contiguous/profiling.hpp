@@ -0,0 +1,484 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <experimental/mdspan>
+#include <initializer_list>
+#include <map>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// The enabled and disabled versions are distinct types, so that translation units built with and without
+// `LAYOUT_CONTIGUOUS_ENABLE_PROFILING` can be linked together without violating the one definition rule.
+#if defined( LAYOUT_CONTIGUOUS_ENABLE_PROFILING )
+inline namespace profiling_enabled
+#else
+inline namespace profiling_disabled
+#endif
+{
+
+/// Statistics on the accesses made through a profiled view, typically one instance per call site.
+/// Recording is not thread-safe, profiled kernels should run sequentially. The memory used is proportional to the
+/// number of distinct strides and cache lines, not to the number of accesses.
+class access_profile
+{
+public:
+    explicit access_profile( std::string name, std::size_t cache_line_size = 64 )
+        : m_name( std::move( name ) )
+        , m_cache_line_size( cache_line_size )
+    {
+    }
+
+    std::string const& name() const noexcept
+    {
+        return m_name;
+    }
+
+    /// Number of recorded element accesses
+    std::size_t access_count() const noexcept
+    {
+        return m_count;
+    }
+
+    /// Number of occurrences of each distance, in elements, between two consecutive accesses
+    std::map< std::ptrdiff_t, std::size_t > const& stride_histogram() const noexcept
+    {
+        return m_strides;
+    }
+
+    /// Fraction of consecutive accesses separated by exactly one element
+    double unit_stride_fraction() const noexcept
+    {
+        std::map< std::ptrdiff_t, std::size_t >::const_iterator const it = m_strides.find( 1 );
+        return m_count > 1 && it != m_strides.end() ? double( it->second ) / double( m_count - 1 ) : 0.;
+    }
+
+    /// Number of cache lines touched for the first time
+    std::size_t cold_cache_lines() const noexcept
+    {
+        return m_last_use.size();
+    }
+
+    /// Histogram of the number of distinct cache lines touched between two accesses to the same line,
+    /// bucket 0 counts the distance 0 and bucket k > 0 the distances in [2^(k-1), 2^k)
+    std::vector< std::size_t > const& reuse_distance_histogram() const noexcept
+    {
+        return m_reuse_distances;
+    }
+
+    /// Per dimension, number of consecutive accesses that only increment this dimension by one
+    std::vector< std::size_t > const& unit_steps() const noexcept
+    {
+        return m_unit_steps;
+    }
+
+    void record_address( std::uintptr_t address, std::size_t element_size )
+    {
+        if ( m_count > 0 )
+        {
+            std::ptrdiff_t const delta = std::ptrdiff_t( address ) - std::ptrdiff_t( m_last_address );
+            ++m_strides[ delta / std::ptrdiff_t( element_size ) ];
+        }
+        m_last_address = address;
+
+        ++m_count;
+        if ( m_time == m_marks.size() )
+        {
+            compact_marks();
+        }
+        std::size_t const now = m_time++;
+        std::uintptr_t const line = address / m_cache_line_size;
+        std::unordered_map< std::uintptr_t, std::size_t >::iterator const it = m_last_use.find( line );
+        if ( it == m_last_use.end() )
+        {
+            m_last_use.emplace( line, now );
+        }
+        else
+        {
+            // Only the last access of each line is marked, marks after it count the distinct lines touched since
+            std::size_t const distance = marks_before( now ) - marks_before( it->second + 1 );
+            std::size_t bucket = 0;
+            while ( ( std::size_t( 1 ) << bucket ) <= distance )
+            {
+                ++bucket;
+            }
+            if ( bucket >= m_reuse_distances.size() )
+            {
+                m_reuse_distances.resize( bucket + 1, 0 );
+            }
+            ++m_reuse_distances[ bucket ];
+            add_mark( it->second, -1 );
+            it->second = now;
+        }
+        add_mark( now, 1 );
+    }
+
+    void record_indices( std::ptrdiff_t const* indices, std::size_t rank )
+    {
+        if ( m_last_indices.size() == rank )
+        {
+            std::size_t n_changed = 0;
+            std::size_t changed = 0;
+            for ( std::size_t d = 0; d < rank; ++d )
+            {
+                if ( indices[ d ] != m_last_indices[ d ] )
+                {
+                    ++n_changed;
+                    changed = d;
+                }
+            }
+            if ( n_changed == 1 && indices[ changed ] == m_last_indices[ changed ] + 1 )
+            {
+                ++m_unit_steps[ changed ];
+            }
+        }
+        else
+        {
+            m_unit_steps.assign( rank, 0 );
+        }
+        m_last_indices.assign( indices, indices + rank );
+    }
+
+    void reset()
+    {
+        *this = access_profile( std::move( m_name ), m_cache_line_size );
+    }
+
+    void write_json( std::ostream& os ) const
+    {
+        os << "{\"name\": \"";
+        for ( char c : m_name )
+        {
+            if ( c == '"' || c == '\\' )
+            {
+                os << '\\';
+            }
+            os << c;
+        }
+        os << "\", \"enabled\": " << ( s_enabled ? "true" : "false" );
+        os << ", \"accesses\": " << m_count;
+        os << ", \"unit_stride_fraction\": " << unit_stride_fraction();
+        os << ", \"stride_histogram\": {";
+        char const* sep = "";
+        for ( std::pair< std::ptrdiff_t const, std::size_t > const& stride : m_strides )
+        {
+            os << sep << '"' << stride.first << "\": " << stride.second;
+            sep = ", ";
+        }
+        os << "}, \"cold_cache_lines\": " << cold_cache_lines();
+        os << ", \"reuse_distance_histogram\": [";
+        sep = "";
+        for ( std::size_t count : m_reuse_distances )
+        {
+            os << sep << count;
+            sep = ", ";
+        }
+        os << "], \"unit_steps\": [";
+        sep = "";
+        for ( std::size_t count : m_unit_steps )
+        {
+            os << sep << count;
+            sep = ", ";
+        }
+        os << "]}";
+    }
+
+private:
+#if defined( LAYOUT_CONTIGUOUS_ENABLE_PROFILING )
+    static constexpr bool s_enabled = true;
+#else
+    static constexpr bool s_enabled = false;
+#endif
+
+    // Fenwick tree over the access times, a time is marked if it is the last access of its cache line. Only the order
+    // of the marked times matters: when the tree is full, they are renumbered from 0 so that its size stays
+    // proportional to the number of distinct cache lines.
+    void compact_marks()
+    {
+        std::vector< std::pair< std::size_t, std::size_t* > > live;
+        live.reserve( m_last_use.size() );
+        for ( std::pair< std::uintptr_t const, std::size_t >& use : m_last_use )
+        {
+            live.emplace_back( use.second, &use.second );
+        }
+        std::sort( live.begin(), live.end(), []( auto const& lhs, auto const& rhs ) { return lhs.first < rhs.first; } );
+        for ( std::size_t t = 0; t < live.size(); ++t )
+        {
+            *live[ t ].second = t;
+        }
+        m_time = live.size();
+
+        std::size_t const size = 2 * m_time + 64;
+        m_marks.assign( size, 0 );
+        std::fill_n( m_marks.begin(), m_time, 1 );
+        m_tree.assign( size + 1, 0 );
+        for ( std::size_t i = 0; i < size; ++i )
+        {
+            m_tree[ i + 1 ] += m_marks[ i ];
+            std::size_t const parent = ( i + 1 ) + ( ( i + 1 ) & ( ~( i + 1 ) + 1 ) );
+            if ( parent <= size )
+            {
+                m_tree[ parent ] += m_tree[ i + 1 ];
+            }
+        }
+    }
+
+    void add_mark( std::size_t time, int value )
+    {
+        m_marks[ time ] += value;
+        for ( std::size_t i = time + 1; i < m_tree.size(); i += i & ( ~i + 1 ) )
+        {
+            m_tree[ i ] += value;
+        }
+    }
+
+    /// Number of marks in [0, time)
+    std::size_t marks_before( std::size_t time ) const
+    {
+        std::ptrdiff_t sum = 0;
+        for ( std::size_t i = time; i > 0; i -= i & ( ~i + 1 ) )
+        {
+            sum += m_tree[ i ];
+        }
+        return sum;
+    }
+
+    std::string m_name;
+
+    std::size_t m_cache_line_size;
+
+    std::size_t m_count = 0;
+
+    /// Time of the next access in the Fenwick tree
+    std::size_t m_time = 0;
+
+    std::uintptr_t m_last_address = 0;
+
+    std::map< std::ptrdiff_t, std::size_t > m_strides;
+
+    std::unordered_map< std::uintptr_t, std::size_t > m_last_use;
+
+    std::vector< int > m_marks;
+
+    std::vector< std::ptrdiff_t > m_tree;
+
+    std::vector< std::size_t > m_reuse_distances;
+
+    std::vector< std::ptrdiff_t > m_last_indices;
+
+    std::vector< std::size_t > m_unit_steps;
+};
+
+/// Writes a JSON array of profiles
+inline void
+write_json( std::ostream& os, std::initializer_list< access_profile const* > profiles )
+{
+    os << "[";
+    char const* sep = "";
+    for ( access_profile const* profile : profiles )
+    {
+        os << sep;
+        profile->write_json( os );
+        sep = ",\n ";
+    }
+    os << "]\n";
+}
+
+/// Accessor recording the address of every accessed element in an `access_profile`
+template < class ElementType >
+class profiling_accessor
+{
+public:
+    using offset_policy = profiling_accessor;
+    using element_type = ElementType;
+    using reference = ElementType&;
+    using data_handle_type = ElementType*;
+
+    constexpr profiling_accessor() noexcept = default;
+
+    constexpr explicit profiling_accessor( access_profile* profile ) noexcept : m_profile( profile )
+    {
+    }
+
+    template < class OtherElementType,
+               std::enable_if_t< std::is_convertible_v< OtherElementType ( * )[], ElementType ( * )[] >, int > = 0 >
+    constexpr profiling_accessor( profiling_accessor< OtherElementType > const& other ) noexcept
+        : m_profile( other.profile() )
+    {
+    }
+
+    reference access( data_handle_type p, std::size_t i ) const
+    {
+        if ( m_profile )
+        {
+            m_profile->record_address( reinterpret_cast< std::uintptr_t >( p + i ), sizeof( ElementType ) );
+        }
+        return p[ i ];
+    }
+
+    constexpr data_handle_type offset( data_handle_type p, std::size_t i ) const noexcept
+    {
+        return p + i;
+    }
+
+    constexpr access_profile* profile() const noexcept
+    {
+        return m_profile;
+    }
+
+private:
+    access_profile* m_profile = nullptr;
+};
+
+/// Layout wrapping the mapping of `Layout` to record every accessed multi-index in an `access_profile`
+template < class Layout >
+struct profiling_layout
+{
+    template < class Extents >
+    class mapping
+    {
+    public:
+        using underlying_mapping_type = typename Layout::template mapping< Extents >;
+        using extents_type = Extents;
+        using index_type = typename extents_type::index_type;
+        using size_type = typename extents_type::size_type;
+        using rank_type = typename extents_type::rank_type;
+        using layout_type = profiling_layout;
+
+        constexpr mapping() noexcept = default;
+
+        constexpr mapping( mapping const& ) noexcept = default;
+
+        constexpr mapping( underlying_mapping_type const& m, access_profile* profile = nullptr ) noexcept
+            : m_mapping( m )
+            , m_profile( profile )
+        {
+        }
+
+        constexpr mapping& operator=( mapping const& ) noexcept = default;
+
+        constexpr underlying_mapping_type const& underlying_mapping() const noexcept
+        {
+            return m_mapping;
+        }
+
+        constexpr access_profile* profile() const noexcept
+        {
+            return m_profile;
+        }
+
+        constexpr extents_type const& extents() const noexcept
+        {
+            return m_mapping.extents();
+        }
+
+        constexpr index_type required_span_size() const noexcept
+        {
+            return m_mapping.required_span_size();
+        }
+
+        template < class... Indices >
+        index_type operator()( Indices... indices ) const
+        {
+            if ( m_profile )
+            {
+                std::array< std::ptrdiff_t, sizeof...( Indices ) > const idx { std::ptrdiff_t( indices )... };
+                m_profile->record_indices( idx.data(), idx.size() );
+            }
+            return m_mapping( indices... );
+        }
+
+        static constexpr bool is_always_unique() noexcept
+        {
+            return underlying_mapping_type::is_always_unique();
+        }
+
+        static constexpr bool is_always_exhaustive() noexcept
+        {
+            return underlying_mapping_type::is_always_exhaustive();
+        }
+
+        static constexpr bool is_always_strided() noexcept
+        {
+            return underlying_mapping_type::is_always_strided();
+        }
+
+        constexpr bool is_unique() const noexcept
+        {
+            return m_mapping.is_unique();
+        }
+
+        constexpr bool is_exhaustive() const noexcept
+        {
+            return m_mapping.is_exhaustive();
+        }
+
+        constexpr bool is_strided() const noexcept
+        {
+            return m_mapping.is_strided();
+        }
+
+        constexpr index_type stride( rank_type i ) const noexcept
+        {
+            return m_mapping.stride( i );
+        }
+
+        friend constexpr bool operator==( mapping const& lhs, mapping const& rhs ) noexcept
+        {
+            return lhs.m_mapping == rhs.m_mapping;
+        }
+
+    private:
+        underlying_mapping_type m_mapping;
+
+        access_profile* m_profile = nullptr;
+    };
+};
+
+/// Returns a view of `x` recording its accesses in `profile` if `LAYOUT_CONTIGUOUS_ENABLE_PROFILING` is defined,
+/// `x` itself otherwise so that profiling can be left in production code at no cost.
+template < class ET, class EP, class LP, class AP >
+auto
+profiled( std::experimental::mdspan< ET, EP, LP, AP > const& x, [[maybe_unused]] access_profile& profile )
+{
+#if defined( LAYOUT_CONTIGUOUS_ENABLE_PROFILING )
+    static_assert( std::is_same_v< typename AP::data_handle_type, ET* > );
+    using mapping_type = typename profiling_layout< LP >::template mapping< EP >;
+    return std::experimental::mdspan< ET, EP, profiling_layout< LP >, profiling_accessor< ET > >(
+        x.data_handle(), mapping_type( x.mapping(), &profile ), profiling_accessor< ET >( &profile ) );
+#else
+    return x;
+#endif
+}
+
+} // inline namespace
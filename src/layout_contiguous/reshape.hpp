@@ -0,0 +1,205 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "layout_contiguous.hpp"
+#include "linear_span.hpp"
+
+namespace detail
+{
+
+/// Computes the strides of the mapping `m` reshaped to `new_extents` in the memory order of its layout.
+/// Returns false if it would require a copy, that is if dimensions to be merged are not contiguous with each other.
+template < class Mapping, class NewExtents >
+bool
+reshape_strides( Mapping const& m, NewExtents const& new_extents,
+                 std::array< typename NewExtents::index_type, NewExtents::rank() >& new_strides )
+{
+    using index_type = typename NewExtents::index_type;
+    constexpr std::size_t old_rank = Mapping::extents_type::rank();
+    constexpr std::size_t new_rank = NewExtents::rank();
+    constexpr bool at_left = Mapping::contiguous_index() == 0;
+
+    // Dimensions are listed from the contiguous one outwards, dimensions of extent 1 being irrelevant are skipped
+    std::array< index_type, old_rank > old_extents {};
+    std::array< index_type, old_rank > old_strides {};
+    std::size_t n_old = 0;
+    for ( std::size_t k = 0; k < old_rank; ++k )
+    {
+        std::size_t const d = at_left ? k : old_rank - 1 - k;
+        if ( m.extents().extent( d ) != 1 )
+        {
+            old_extents[ n_old ] = m.extents().extent( d );
+            old_strides[ n_old ] = m.stride( d );
+            ++n_old;
+        }
+    }
+    std::array< std::size_t, new_rank > new_dims {};
+    std::size_t n_new = 0;
+    for ( std::size_t k = 0; k < new_rank; ++k )
+    {
+        std::size_t const d = at_left ? k : new_rank - 1 - k;
+        if ( new_extents.extent( d ) != 1 )
+        {
+            new_dims[ n_new++ ] = d;
+        }
+    }
+
+    // Each group of old dimensions is matched with the group of new dimensions of the same size
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while ( i < n_old && j < n_new )
+    {
+        std::size_t const i_first = i;
+        std::size_t const j_first = j;
+        index_type old_size = old_extents[ i ];
+        index_type new_size = new_extents.extent( new_dims[ j ] );
+        while ( old_size != new_size )
+        {
+            if ( old_size < new_size )
+            {
+                if ( ++i == n_old )
+                {
+                    return false;
+                }
+                old_size *= old_extents[ i ];
+            }
+            else
+            {
+                if ( ++j == n_new )
+                {
+                    return false;
+                }
+                new_size *= new_extents.extent( new_dims[ j ] );
+            }
+        }
+        for ( std::size_t k = i_first; k < i; ++k )
+        {
+            if ( old_strides[ k + 1 ] != old_strides[ k ] * old_extents[ k ] )
+            {
+                return false;
+            }
+        }
+        index_type stride = old_strides[ i_first ];
+        for ( std::size_t k = j_first; k <= j; ++k )
+        {
+            new_strides[ new_dims[ k ] ] = stride;
+            stride *= new_extents.extent( new_dims[ k ] );
+        }
+        ++i;
+        ++j;
+    }
+    if ( i != n_old || j != n_new )
+    {
+        return false;
+    }
+
+    // Any stride fits a dimension of extent 1, take the one of a contiguous layout
+    index_type stride = 1;
+    for ( std::size_t k = 0; k < new_rank; ++k )
+    {
+        std::size_t const d = at_left ? k : new_rank - 1 - k;
+        if ( new_extents.extent( d ) == 1 )
+        {
+            new_strides[ d ] = stride;
+        }
+        else
+        {
+            stride = new_strides[ d ] * new_extents.extent( d );
+        }
+    }
+    return new_strides[ at_left ? 0 : new_rank - 1 ] == 1;
+}
+
+template < class Extents >
+constexpr typename Extents::index_type
+extents_size( Extents const& extents ) noexcept
+{
+    typename Extents::index_type size = 1;
+    for ( std::size_t d = 0; d < Extents::rank(); ++d )
+    {
+        size *= extents.extent( d );
+    }
+    return size;
+}
+
+} // namespace detail
+
+/// Views `x` with `new_extents` without copying, the elements being taken in the memory order of the layout
+/// (row-major for `layout_contiguous_at_right`, column-major for `layout_contiguous_at_left`). Only the dimensions
+/// that are merged need to be contiguous with each other. Returns an empty optional if the strides of `x` require a
+/// copy and throws if the sizes do not match, which is checked at compile-time for static extents.
+template < class ET, class EP, class LP, class AP, class NewExtents >
+std::optional< std::experimental::mdspan< ET, NewExtents, LP, AP > >
+try_reshape( std::experimental::mdspan< ET, EP, LP, AP > const& x, NewExtents const& new_extents )
+{
+    using new_mapping_type = typename LP::template mapping< NewExtents >;
+    static_assert( detail::is_layout_contiguous_v< LP > );
+    if constexpr ( EP::rank_dynamic() == 0 && NewExtents::rank_dynamic() == 0 )
+    {
+        static_assert( detail::static_size< EP >( std::make_index_sequence< EP::rank() >() ) ==
+                           detail::static_size< NewExtents >( std::make_index_sequence< NewExtents::rank() >() ),
+                       "The new extents should have the same size" );
+    }
+    else if ( detail::extents_size( x.extents() ) != detail::extents_size( new_extents ) )
+    {
+        throw std::runtime_error( "The new extents should have the same size" );
+    }
+
+    if ( detail::extents_size( new_extents ) == 0 )
+    {
+        return std::experimental::mdspan< ET, NewExtents, LP, AP >( x.data_handle(), new_mapping_type( new_extents ),
+                                                                    x.accessor() );
+    }
+
+    std::array< typename NewExtents::index_type, NewExtents::rank() > new_strides;
+    if ( !detail::reshape_strides( x.mapping(), new_extents, new_strides ) )
+    {
+        return std::nullopt;
+    }
+    std::experimental::layout_stride::mapping< NewExtents > const strided( new_extents, new_strides );
+    return std::experimental::mdspan< ET, NewExtents, LP, AP >( x.data_handle(), new_mapping_type( strided ),
+                                                                x.accessor() );
+}
+
+/// Same as `try_reshape` but throws if the strides of `x` require a copy
+template < class ET, class EP, class LP, class AP, class NewExtents >
+std::experimental::mdspan< ET, NewExtents, LP, AP >
+reshape( std::experimental::mdspan< ET, EP, LP, AP > const& x, NewExtents const& new_extents )
+{
+    std::optional< std::experimental::mdspan< ET, NewExtents, LP, AP > > const y = try_reshape( x, new_extents );
+    if ( !y )
+    {
+        throw std::runtime_error( "The strides do not allow to reshape without copy" );
+    }
+    return *y;
+}
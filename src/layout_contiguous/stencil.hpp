@@ -0,0 +1,333 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "layout_contiguous.hpp"
+#include "openmp.hpp"
+#include "traversal.hpp"
+
+/// Point of a stencil given by its compile-time offset in each dimension
+template < int... Offsets >
+struct stencil_point
+{
+    static constexpr std::size_t rank() noexcept
+    {
+        return sizeof...( Offsets );
+    }
+
+    static constexpr std::array< int, sizeof...( Offsets ) > offsets() noexcept
+    {
+        return { Offsets... };
+    }
+};
+
+/// Linear stencil: a compile-time set of points and their runtime coefficients
+template < class T, class... Points >
+class stencil
+{
+    static_assert( sizeof...( Points ) > 0 );
+
+    static constexpr std::size_t s_rank = std::tuple_element_t< 0, std::tuple< Points... > >::rank();
+
+    static_assert( ( ... && ( Points::rank() == s_rank ) ) );
+
+public:
+    using value_type = T;
+
+    static constexpr std::size_t rank() noexcept
+    {
+        return s_rank;
+    }
+
+    static constexpr std::size_t size() noexcept
+    {
+        return sizeof...( Points );
+    }
+
+    static constexpr std::array< std::array< int, s_rank >, sizeof...( Points ) > offsets() noexcept
+    {
+        return { Points::offsets()... };
+    }
+
+    /// Number of points needed before the first interior point in dimension `d`
+    static constexpr int lower_halo( std::size_t d ) noexcept
+    {
+        int halo = 0;
+        for ( std::array< int, s_rank > const& offset : offsets() )
+        {
+            halo = std::max( halo, -offset[ d ] );
+        }
+        return halo;
+    }
+
+    /// Number of points needed after the last interior point in dimension `d`
+    static constexpr int upper_halo( std::size_t d ) noexcept
+    {
+        int halo = 0;
+        for ( std::array< int, s_rank > const& offset : offsets() )
+        {
+            halo = std::max( halo, offset[ d ] );
+        }
+        return halo;
+    }
+
+    constexpr stencil( std::array< T, sizeof...( Points ) > const& coefficients ) noexcept
+        : m_coefficients( coefficients )
+    {
+    }
+
+    constexpr std::array< T, sizeof...( Points ) > const& coefficients() const noexcept
+    {
+        return m_coefficients;
+    }
+
+private:
+    std::array< T, sizeof...( Points ) > m_coefficients;
+};
+
+namespace detail
+{
+
+/// Computes the box [lb, ub) of the points whose neighbours all lie inside `extents`, the box being empty (`ub == lb`)
+/// when an extent is at most the sum of its halos. Bounds are computed in signed arithmetic so that they do not wrap
+/// with an unsigned `index_type`.
+template < class Stencil, class Extents >
+constexpr void
+stencil_interior( Extents const& extents, std::array< typename Extents::index_type, Extents::rank() >& lb,
+                  std::array< typename Extents::index_type, Extents::rank() >& ub ) noexcept
+{
+    using index_type = typename Extents::index_type;
+    static_assert( Stencil::rank() == Extents::rank() );
+    bool empty = false;
+    for ( std::size_t d = 0; d < Extents::rank(); ++d )
+    {
+        std::ptrdiff_t const upper = static_cast< std::ptrdiff_t >( extents.extent( d ) ) - Stencil::upper_halo( d );
+        lb[ d ] = static_cast< index_type >( Stencil::lower_halo( d ) );
+        ub[ d ] = static_cast< index_type >( std::max< std::ptrdiff_t >( Stencil::lower_halo( d ), upper ) );
+        empty = empty || ub[ d ] == lb[ d ];
+    }
+    if ( empty )
+    {
+        ub = lb;
+    }
+}
+
+/// Applies the stencil on the box [lb, ub), one contiguous run at a time.
+/// Neighbours are reached through constant pointer shifts from the current run.
+template < class ExecutionPolicy, class Stencil, class DstSpan, class SrcSpan, std::size_t... Ps >
+void
+apply_stencil_box( ExecutionPolicy exec, Stencil const& st, DstSpan const& dst, SrcSpan const& src,
+                   std::array< typename DstSpan::index_type, DstSpan::rank() > const& lb,
+                   std::array< typename DstSpan::index_type, DstSpan::rank() > const& ub,
+                   std::index_sequence< Ps... > )
+{
+    using index_type = typename DstSpan::index_type;
+    constexpr std::size_t cont = DstSpan::mapping_type::contiguous_index();
+    constexpr std::array< std::array< int, Stencil::rank() >, Stencil::size() > offsets = Stencil::offsets();
+
+    std::array< std::ptrdiff_t, Stencil::size() > shifts {};
+    for ( std::size_t p = 0; p < Stencil::size(); ++p )
+    {
+        for ( std::size_t d = 0; d < Stencil::rank(); ++d )
+        {
+            shifts[ p ] += std::ptrdiff_t( offsets[ p ][ d ] ) * std::ptrdiff_t( src.mapping().stride( d ) );
+        }
+    }
+    std::array< typename Stencil::value_type, Stencil::size() > const c = st.coefficients();
+    index_type const len = ub[ cont ] - lb[ cont ];
+
+    for_each_run< cont >( exec, lb, ub, [ & ]( std::array< index_type, DstSpan::rank() > const& idx ) {
+        typename DstSpan::element_type* const out = dst.data_handle() + std::apply( dst.mapping(), idx );
+        typename SrcSpan::element_type const* const in = src.data_handle() + std::apply( src.mapping(), idx );
+        LAYOUT_CONTIGUOUS_SIMD
+        for ( index_type i = 0; i < len; ++i )
+        {
+            out[ i ] = ( ... + ( c[ Ps ] * in[ i + shifts[ Ps ] ] ) );
+        }
+    } );
+}
+
+/// Applies the stencil on the box [lb, ub) split into tiles, a tile size of 0 meaning the whole box extent
+template < class ExecutionPolicy, class Stencil, class DstSpan, class SrcSpan >
+void
+apply_stencil_tiled( ExecutionPolicy exec, Stencil const& st, DstSpan const& dst, SrcSpan const& src,
+                     std::array< typename DstSpan::index_type, DstSpan::rank() > const& lb,
+                     std::array< typename DstSpan::index_type, DstSpan::rank() > const& ub,
+                     std::array< typename DstSpan::index_type, DstSpan::rank() > const& tile )
+{
+    using index_type = typename DstSpan::index_type;
+    constexpr std::size_t rank = DstSpan::rank();
+    constexpr std::size_t cont = DstSpan::mapping_type::contiguous_index();
+
+    std::array< index_type, rank > tile_sizes;
+    std::array< index_type, rank > tile_counts;
+    index_type n_tiles = 1;
+    for ( std::size_t d = 0; d < rank; ++d )
+    {
+        index_type const width = ub[ d ] > lb[ d ] ? ub[ d ] - lb[ d ] : 0;
+        tile_sizes[ d ] = tile[ d ] > 0 ? std::min( tile[ d ], width ) : width;
+        tile_counts[ d ] = tile_sizes[ d ] > 0 ? ( width + tile_sizes[ d ] - 1 ) / tile_sizes[ d ] : 0;
+        n_tiles *= tile_counts[ d ];
+    }
+
+    auto apply_tile = [ & ]( auto tile_exec, index_type n ) {
+        std::array< index_type, rank > const t = unravel< cont >( std::array< index_type, rank > {}, tile_counts, n );
+        std::array< index_type, rank > tile_lb;
+        std::array< index_type, rank > tile_ub;
+        for ( std::size_t d = 0; d < rank; ++d )
+        {
+            tile_lb[ d ] = lb[ d ] + t[ d ] * tile_sizes[ d ];
+            tile_ub[ d ] = std::min( tile_lb[ d ] + tile_sizes[ d ], ub[ d ] );
+        }
+        apply_stencil_box( tile_exec, st, dst, src, tile_lb, tile_ub, std::make_index_sequence< Stencil::size() >() );
+    };
+
+    if constexpr ( is_parallel_execution_v< ExecutionPolicy > )
+    {
+        if ( n_tiles > 1 )
+        {
+            LAYOUT_CONTIGUOUS_OMP( parallel for schedule( dynamic ) )
+            for ( index_type n = 0; n < n_tiles; ++n )
+            {
+                apply_tile( sequential_policy( exec ), n );
+            }
+            return;
+        }
+    }
+    for ( index_type n = 0; n < n_tiles; ++n )
+    {
+        apply_tile( exec, n );
+    }
+}
+
+} // namespace detail
+
+/// Computes `dst = st( src )` at every point whose neighbours all lie inside `src`, points of `dst` in the halo are
+/// left untouched. The interior is traversed by tiles of size `tile`, 0 meaning the whole extent of the dimension, the
+/// runs of each tile being visited in lexicographic order, or in Z-order with a `morton_order` policy.
+template < class ExecutionPolicy, class T, class... Points, class DstET, class SrcET, class EP, class Layout,
+           class DstAP, class SrcAP >
+void
+apply_stencil( ExecutionPolicy exec, std::experimental::mdspan< DstET, EP, Layout, DstAP > const& dst,
+               std::experimental::mdspan< SrcET, EP, Layout, SrcAP > const& src, stencil< T, Points... > const& st,
+               std::array< typename EP::index_type, EP::rank() > const& tile = {} )
+{
+    static_assert( detail::is_layout_contiguous_v< Layout > );
+    static_assert( stencil< T, Points... >::rank() == EP::rank() );
+    assert( dst.extents() == src.extents() );
+
+    std::array< typename EP::index_type, EP::rank() > lb;
+    std::array< typename EP::index_type, EP::rank() > ub;
+    detail::stencil_interior< stencil< T, Points... > >( src.extents(), lb, ub );
+    detail::apply_stencil_tiled( exec, st, dst, src, lb, ub, tile );
+}
+
+template < class T, class... Points, class DstET, class SrcET, class EP, class Layout, class DstAP, class SrcAP >
+void
+apply_stencil( std::experimental::mdspan< DstET, EP, Layout, DstAP > const& dst,
+               std::experimental::mdspan< SrcET, EP, Layout, SrcAP > const& src, stencil< T, Points... > const& st,
+               std::array< typename EP::index_type, EP::rank() > const& tile = {} )
+{
+    apply_stencil( sequential_execution {}, dst, src, st, tile );
+}
+
+/// Applies `n_sweeps` times the stencil, ping-ponging between `a` (the initial state) and `b`, and returns the view
+/// holding the last sweep. The halo of `b` must hold the same boundary values as the halo of `a`.
+/// Sweeps are grouped by `time_block` and advanced together along a wavefront over the outermost dimension, so that
+/// the planes produced by one sweep are consumed by the next one while still in cache.
+template < class ExecutionPolicy, class T, class... Points, class ET, class EP, class Layout, class AP >
+std::experimental::mdspan< ET, EP, Layout, AP >
+apply_stencil_sweeps( ExecutionPolicy exec, std::experimental::mdspan< ET, EP, Layout, AP > const& a,
+                      std::experimental::mdspan< ET, EP, Layout, AP > const& b, stencil< T, Points... > const& st,
+                      int n_sweeps, int time_block = 1,
+                      std::array< typename EP::index_type, EP::rank() > const& tile = {} )
+{
+    using index_type = typename EP::index_type;
+    using stencil_type = stencil< T, Points... >;
+    constexpr std::size_t cont = Layout::template mapping< EP >::contiguous_index();
+    constexpr std::size_t outer = cont == 0 ? EP::rank() - 1 : 0;
+    static_assert( detail::is_layout_contiguous_v< Layout > );
+    static_assert( stencil_type::rank() == EP::rank() );
+    assert( a.extents() == b.extents() );
+
+    std::array< index_type, EP::rank() > lb;
+    std::array< index_type, EP::rank() > ub;
+    detail::stencil_interior< stencil_type >( a.extents(), lb, ub );
+    std::array< std::experimental::mdspan< ET, EP, Layout, AP >, 2 > const buffers { a, b };
+
+    // Sweep `t` of a block at plane `p` is computed at wavefront step `p + t * skew`, after sweep `t - 1` produced
+    // the planes it reads and before sweep `t + 1` overwrites the ones still needed.
+    index_type const skew = std::max( stencil_type::lower_halo( outer ), stencil_type::upper_halo( outer ) );
+    int sweep = 0;
+    while ( sweep < n_sweeps )
+    {
+        int const block = outer == cont ? 1 : std::max( 1, std::min( time_block, n_sweeps - sweep ) );
+        if ( block == 1 )
+        {
+            detail::apply_stencil_tiled( exec, st, buffers[ ( sweep + 1 ) % 2 ], buffers[ sweep % 2 ], lb, ub, tile );
+        }
+        else
+        {
+            for ( index_type step = lb[ outer ]; step < ub[ outer ] + ( block - 1 ) * skew; ++step )
+            {
+                for ( int t = 0; t < block; ++t )
+                {
+                    index_type const plane = step - t * skew;
+                    if ( plane < lb[ outer ] || plane >= ub[ outer ] )
+                    {
+                        continue;
+                    }
+                    std::array< index_type, EP::rank() > plane_lb = lb;
+                    std::array< index_type, EP::rank() > plane_ub = ub;
+                    plane_lb[ outer ] = plane;
+                    plane_ub[ outer ] = plane + 1;
+                    detail::apply_stencil_tiled( exec, st, buffers[ ( sweep + t + 1 ) % 2 ],
+                                                 buffers[ ( sweep + t ) % 2 ], plane_lb, plane_ub, tile );
+                }
+            }
+        }
+        sweep += block;
+    }
+    return buffers[ n_sweeps % 2 ];
+}
+
+template < class T, class... Points, class ET, class EP, class Layout, class AP >
+std::experimental::mdspan< ET, EP, Layout, AP >
+apply_stencil_sweeps( std::experimental::mdspan< ET, EP, Layout, AP > const& a,
+                      std::experimental::mdspan< ET, EP, Layout, AP > const& b, stencil< T, Points... > const& st,
+                      int n_sweeps, int time_block = 1,
+                      std::array< typename EP::index_type, EP::rank() > const& tile = {} )
+{
+    return apply_stencil_sweeps( sequential_execution {}, a, b, st, n_sweeps, time_block, tile );
+}
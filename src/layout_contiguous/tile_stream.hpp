@@ -0,0 +1,572 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <experimental/mdspan>
+#include <fcntl.h>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <sys/types.h>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "layout_contiguous.hpp"
+#include "memory.hpp"
+#include "traversal.hpp"
+
+/// How a `file_array` opens its file
+enum class file_mode
+{
+    /// The file must exist and is only read
+    read,
+    /// The file is created or truncated to the size of the array
+    write,
+    /// The file must exist and is read and written
+    read_write
+};
+
+/// Array of `T` stored in a file in `layout_right` order from byte `offset`, accessed by boxes with `pread`/`pwrite`
+template < class T, std::size_t Rank >
+class file_array
+{
+public:
+    using extents_type = std::experimental::dextents< std::size_t, Rank >;
+    using box_type = std::array< std::size_t, Rank >;
+
+    file_array( std::string const& path, box_type const& extents, file_mode mode, off_t offset = 0 )
+        : m_extents( extents )
+        , m_offset( offset )
+    {
+        int const flags = mode == file_mode::read    ? O_RDONLY
+                          : mode == file_mode::write ? O_RDWR | O_CREAT | O_TRUNC
+                                                     : O_RDWR;
+        m_fd = ::open( path.c_str(), flags, 0644 );
+        if ( m_fd < 0 )
+        {
+            throw std::system_error( errno, std::generic_category(), path );
+        }
+        if ( mode == file_mode::write && ::ftruncate( m_fd, m_offset + off_t( size() * sizeof( T ) ) ) != 0 )
+        {
+            int const error = errno;
+            ::close( m_fd );
+            throw std::system_error( error, std::generic_category(), path );
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise( m_fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+    }
+
+    file_array( file_array const& ) = delete;
+
+    file_array( file_array&& rhs ) noexcept
+        : m_fd( std::exchange( rhs.m_fd, -1 ) )
+        , m_extents( rhs.m_extents )
+        , m_offset( rhs.m_offset )
+    {
+    }
+
+    file_array& operator=( file_array const& ) = delete;
+
+    file_array& operator=( file_array&& rhs ) noexcept
+    {
+        std::swap( m_fd, rhs.m_fd );
+        m_extents = rhs.m_extents;
+        m_offset = rhs.m_offset;
+        return *this;
+    }
+
+    ~file_array()
+    {
+        if ( m_fd >= 0 )
+        {
+            ::close( m_fd );
+        }
+    }
+
+    box_type const& extents() const noexcept
+    {
+        return m_extents;
+    }
+
+    std::size_t size() const noexcept
+    {
+        std::size_t size = 1;
+        for ( std::size_t e : m_extents )
+        {
+            size *= e;
+        }
+        return size;
+    }
+
+    /// Reads the box of the array starting at `origin` with the extents of `dst`
+    void read( box_type const& origin,
+               std::experimental::mdspan< T, extents_type, std::experimental::layout_right > const& dst ) const
+    {
+        for_each_file_run( origin, dst.extents(), [ & ]( off_t pos, std::size_t start, std::size_t len ) {
+            char* buf = reinterpret_cast< char* >( dst.data_handle() + start );
+            std::size_t n_bytes = len * sizeof( T );
+            while ( n_bytes > 0 )
+            {
+                ssize_t const n = ::pread( m_fd, buf, n_bytes, pos );
+                if ( n < 0 && errno == EINTR )
+                {
+                    continue;
+                }
+                if ( n <= 0 )
+                {
+                    throw std::system_error( n < 0 ? errno : EIO, std::generic_category(), "pread" );
+                }
+                buf += n;
+                pos += n;
+                n_bytes -= n;
+            }
+        } );
+    }
+
+    /// Writes `src` in the box of the array starting at `origin`
+    void write( box_type const& origin,
+                std::experimental::mdspan< T const, extents_type, std::experimental::layout_right > const& src ) const
+    {
+        for_each_file_run( origin, src.extents(), [ & ]( off_t pos, std::size_t start, std::size_t len ) {
+            char const* buf = reinterpret_cast< char const* >( src.data_handle() + start );
+            std::size_t n_bytes = len * sizeof( T );
+            while ( n_bytes > 0 )
+            {
+                ssize_t const n = ::pwrite( m_fd, buf, n_bytes, pos );
+                if ( n < 0 && errno == EINTR )
+                {
+                    continue;
+                }
+                if ( n < 0 )
+                {
+                    throw std::system_error( errno, std::generic_category(), "pwrite" );
+                }
+                buf += n;
+                pos += n;
+                n_bytes -= n;
+            }
+        } );
+    }
+
+private:
+    /// Calls `f( pos, start, len )` for every run of `len` elements at byte `pos` in the file and at element `start`
+    /// of the box, runs along the trailing dimensions fully covered by the box being merged
+    template < class F >
+    void for_each_file_run( box_type const& origin, extents_type const& box, F&& f ) const
+    {
+        std::size_t first_merged = Rank - 1;
+        while ( first_merged > 0 && box.extent( first_merged ) == m_extents[ first_merged ] )
+        {
+            --first_merged;
+        }
+        std::size_t len = 1;
+        for ( std::size_t d = first_merged; d < Rank; ++d )
+        {
+            len *= box.extent( d );
+        }
+        box_type const lb {};
+        box_type counts;
+        std::size_t n_runs = 1;
+        for ( std::size_t d = 0; d < Rank; ++d )
+        {
+            counts[ d ] = d < first_merged ? box.extent( d ) : 1;
+            n_runs *= counts[ d ];
+        }
+        if ( len == 0 )
+        {
+            return;
+        }
+        for ( std::size_t n = 0; n < n_runs; ++n )
+        {
+            box_type const idx = detail::unravel< Rank - 1 >( lb, counts, n );
+            std::size_t linear = 0;
+            for ( std::size_t d = 0; d < Rank; ++d )
+            {
+                linear = linear * m_extents[ d ] + origin[ d ] + idx[ d ];
+            }
+            f( m_offset + off_t( linear * sizeof( T ) ), n * len, len );
+        }
+    }
+
+    int m_fd = -1;
+
+    box_type m_extents;
+
+    off_t m_offset;
+};
+
+/// Configuration of `stream_tiles`
+template < std::size_t Rank >
+struct tile_stream_config
+{
+    /// Extents of a tile, 0 meaning the whole extent except in the first dimension where the largest extent fitting
+    /// in the memory budget is used. Tiles are visited in file order.
+    std::array< std::size_t, Rank > tile_extents {};
+
+    /// Number of tiles read ahead, and written behind, of the tile being computed
+    std::size_t queue_depth = 2;
+
+    /// Maximum number of bytes of all the tile buffers
+    std::size_t memory_budget = std::size_t( 256 ) << 20;
+};
+
+/// Timings of `stream_tiles` in seconds
+struct tile_stream_statistics
+{
+    std::size_t n_tiles = 0;
+
+    std::size_t bytes_read = 0;
+
+    std::size_t bytes_written = 0;
+
+    double wall_time = 0.;
+
+    /// Time spent in the user function
+    double compute_time = 0.;
+
+    /// Time spent by the background threads reading and writing tiles
+    double read_time = 0.;
+
+    double write_time = 0.;
+
+    /// Time the calling thread waited for a tile to be read or for a buffer to be written back
+    double stall_time = 0.;
+
+    /// Fraction of the I/O time hidden behind computations, 1 when I/O and compute fully overlap
+    double overlap_efficiency() const noexcept
+    {
+        double const io_time = read_time + write_time;
+        return io_time > 0. ? std::clamp( 1. - stall_time / io_time, 0., 1. ) : 1.;
+    }
+
+    void write_json( std::ostream& os ) const
+    {
+        os << "{\"tiles\": " << n_tiles;
+        os << ", \"bytes_read\": " << bytes_read;
+        os << ", \"bytes_written\": " << bytes_written;
+        os << ", \"wall_time\": " << wall_time;
+        os << ", \"compute_time\": " << compute_time;
+        os << ", \"read_time\": " << read_time;
+        os << ", \"write_time\": " << write_time;
+        os << ", \"stall_time\": " << stall_time;
+        os << ", \"overlap_efficiency\": " << overlap_efficiency() << "}\n";
+    }
+};
+
+namespace detail
+{
+
+/// Unbounded FIFO shared between threads, `pop` waiting for an element until the queue is closed
+template < class T >
+class blocking_queue
+{
+public:
+    void push( T value )
+    {
+        {
+            std::lock_guard< std::mutex > const lock( m_mutex );
+            m_queue.push_back( std::move( value ) );
+        }
+        m_cv.notify_one();
+    }
+
+    std::optional< T > pop()
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_cv.wait( lock, [ this ] { return !m_queue.empty() || m_closed; } );
+        if ( m_queue.empty() )
+        {
+            return std::nullopt;
+        }
+        T value = std::move( m_queue.front() );
+        m_queue.pop_front();
+        return value;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard< std::mutex > const lock( m_mutex );
+            m_closed = true;
+        }
+        m_cv.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+
+    std::condition_variable m_cv;
+
+    std::deque< T > m_queue;
+
+    bool m_closed = false;
+};
+
+inline double
+seconds_since( std::chrono::steady_clock::time_point start ) noexcept
+{
+    return std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+}
+
+/// Tile extents with every 0 resolved, throws if the buffers do not fit in the memory budget
+template < class T, std::size_t Rank >
+std::array< std::size_t, Rank >
+resolve_tile_extents( std::array< std::size_t, Rank > const& extents, tile_stream_config< Rank > const& config,
+                      std::size_t n_buffers )
+{
+    if ( config.queue_depth == 0 )
+    {
+        throw std::runtime_error( "The queue depth should be at least 1" );
+    }
+    std::array< std::size_t, Rank > tile = config.tile_extents;
+    std::size_t slice_bytes = sizeof( T ) * n_buffers;
+    for ( std::size_t d = 1; d < Rank; ++d )
+    {
+        tile[ d ] = tile[ d ] == 0 ? extents[ d ] : std::min( tile[ d ], extents[ d ] );
+        slice_bytes *= tile[ d ];
+    }
+    std::size_t const max_slices = slice_bytes == 0 ? extents[ 0 ] : config.memory_budget / slice_bytes;
+    tile[ 0 ] = std::min( tile[ 0 ] == 0 ? max_slices : tile[ 0 ], extents[ 0 ] );
+    if ( tile[ 0 ] > max_slices || ( tile[ 0 ] == 0 && extents[ 0 ] > 0 ) )
+    {
+        throw std::runtime_error( "The tiles do not fit in the memory budget" );
+    }
+    return tile;
+}
+
+/// `dst` is either a pointer to the destination array or `nullptr` for read-only streaming
+template < class T, std::size_t Rank, class Dst, class F >
+tile_stream_statistics
+stream_tiles( file_array< T, Rank > const& src, Dst dst, tile_stream_config< Rank > const& config, F& f )
+{
+    constexpr bool write_back = !std::is_same_v< Dst, std::nullptr_t >;
+    using extents_type = typename file_array< T, Rank >::extents_type;
+    using box_type = typename file_array< T, Rank >::box_type;
+    using tile_type = std::experimental::mdspan< T, extents_type, layout_contiguous_at_right >;
+    using buffer_span = std::experimental::mdspan< T, extents_type, std::experimental::layout_right >;
+
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+    box_type const extents = src.extents();
+    std::size_t const n_buffers = config.queue_depth + 1;
+    box_type const tile = resolve_tile_extents< T >( extents, config, write_back ? 2 * n_buffers : n_buffers );
+    std::size_t tile_size = 1;
+    box_type grid;
+    std::size_t n_tiles = 1;
+    for ( std::size_t d = 0; d < Rank; ++d )
+    {
+        tile_size *= tile[ d ];
+        grid[ d ] = tile[ d ] == 0 ? 0 : ( extents[ d ] + tile[ d ] - 1 ) / tile[ d ];
+        n_tiles *= grid[ d ];
+    }
+
+    // Origin and extents of the t-th tile in file order, the last tiles of each dimension being clipped
+    auto const tile_box = [ & ]( std::size_t t ) {
+        box_type origin = detail::unravel< Rank - 1 >( box_type {}, grid, t );
+        box_type box;
+        for ( std::size_t d = 0; d < Rank; ++d )
+        {
+            origin[ d ] *= tile[ d ];
+            box[ d ] = std::min( tile[ d ], extents[ d ] - origin[ d ] );
+        }
+        return std::make_pair( origin, extents_type( box ) );
+    };
+
+    std::vector< aligned_vector< T > > in_buffers( n_buffers, aligned_vector< T >( tile_size ) );
+    std::vector< aligned_vector< T > > out_buffers( write_back ? n_buffers : 0, aligned_vector< T >( tile_size ) );
+    blocking_queue< std::size_t > free_in;
+    blocking_queue< std::size_t > free_out;
+    blocking_queue< std::pair< std::size_t, std::size_t > > ready;
+    blocking_queue< std::pair< std::size_t, std::size_t > > written;
+    for ( std::size_t b = 0; b < n_buffers; ++b )
+    {
+        free_in.push( b );
+        if constexpr ( write_back )
+        {
+            free_out.push( b );
+        }
+    }
+
+    tile_stream_statistics stats;
+    stats.n_tiles = n_tiles;
+    std::exception_ptr read_error;
+    std::exception_ptr write_error;
+
+    std::thread reader( [ & ] {
+        try
+        {
+            for ( std::size_t t = 0; t < n_tiles; ++t )
+            {
+                std::optional< std::size_t > const b = free_in.pop();
+                if ( !b )
+                {
+                    break;
+                }
+                std::chrono::steady_clock::time_point const read_start = std::chrono::steady_clock::now();
+                auto const [ origin, box ] = tile_box( t );
+                buffer_span const buffer( in_buffers[ *b ].data(), box );
+                src.read( origin, buffer );
+                stats.read_time += seconds_since( read_start );
+                stats.bytes_read += sizeof( T ) * buffer.size();
+                ready.push( { t, *b } );
+            }
+        }
+        catch ( ... )
+        {
+            read_error = std::current_exception();
+        }
+        ready.close();
+    } );
+
+    // Stops and joins the background threads, also when `f` throws or the writer cannot be started
+    std::thread writer;
+    auto const join = [ & ] {
+        written.close();
+        if ( writer.joinable() )
+        {
+            writer.join();
+        }
+        free_in.close();
+        reader.join();
+    };
+
+    try
+    {
+        if constexpr ( write_back )
+        {
+            writer = std::thread( [ & ] {
+                try
+                {
+                    while ( std::optional< std::pair< std::size_t, std::size_t > > const item = written.pop() )
+                    {
+                        std::chrono::steady_clock::time_point const write_start = std::chrono::steady_clock::now();
+                        auto const [ origin, box ] = tile_box( item->first );
+                        buffer_span const buffer( out_buffers[ item->second ].data(), box );
+                        dst->write( origin, buffer );
+                        stats.write_time += seconds_since( write_start );
+                        stats.bytes_written += sizeof( T ) * buffer.size();
+                        free_out.push( item->second );
+                    }
+                }
+                catch ( ... )
+                {
+                    write_error = std::current_exception();
+                }
+                free_out.close();
+            } );
+        }
+
+        for ( std::size_t t = 0; t < n_tiles; ++t )
+        {
+            std::chrono::steady_clock::time_point const wait_start = std::chrono::steady_clock::now();
+            std::optional< std::pair< std::size_t, std::size_t > > const in = ready.pop();
+            std::optional< std::size_t > const out = write_back ? free_out.pop() : std::optional< std::size_t >( 0 );
+            stats.stall_time += seconds_since( wait_start );
+            if ( !in || !out )
+            {
+                break;
+            }
+
+            std::chrono::steady_clock::time_point const compute_start = std::chrono::steady_clock::now();
+            auto const [ origin, box ] = tile_box( t );
+            if constexpr ( write_back )
+            {
+                f( origin, tile_type( buffer_span( in_buffers[ in->second ].data(), box ) ),
+                   tile_type( buffer_span( out_buffers[ *out ].data(), box ) ) );
+            }
+            else
+            {
+                f( origin, tile_type( buffer_span( in_buffers[ in->second ].data(), box ) ) );
+            }
+            stats.compute_time += seconds_since( compute_start );
+
+            free_in.push( in->second );
+            if constexpr ( write_back )
+            {
+                written.push( { t, *out } );
+            }
+        }
+    }
+    catch ( ... )
+    {
+        join();
+        throw;
+    }
+
+    // Waiting for the last writes is part of the stall
+    std::chrono::steady_clock::time_point const drain_start = std::chrono::steady_clock::now();
+    join();
+    stats.stall_time += seconds_since( drain_start );
+    if ( read_error )
+    {
+        std::rethrow_exception( read_error );
+    }
+    if ( write_error )
+    {
+        std::rethrow_exception( write_error );
+    }
+    stats.wall_time = seconds_since( start );
+    return stats;
+}
+
+} // namespace detail
+
+/// Calls `f( origin, tile )` on every tile of `src` in file order, `tile` being a contiguous view of the box starting
+/// at `origin`. The next `queue_depth` tiles are read by a background thread into a ring of aligned buffers while
+/// `f` runs on the calling thread.
+template < class T, std::size_t Rank, class F >
+tile_stream_statistics
+stream_tiles( file_array< T, Rank > const& src, tile_stream_config< Rank > const& config, F&& f )
+{
+    return detail::stream_tiles( src, nullptr, config, f );
+}
+
+/// Calls `f( origin, in, out )` on every tile of `src` in file order, `out` being written back asynchronously to the
+/// same box of `dst` by a second background thread once `f` returns. `src` and `dst` may refer to the same file.
+template < class T, std::size_t Rank, class F >
+tile_stream_statistics
+stream_tiles( file_array< T, Rank > const& src, file_array< T, Rank > const& dst,
+              tile_stream_config< Rank > const& config, F&& f )
+{
+    if ( src.extents() != dst.extents() )
+    {
+        throw std::runtime_error( "The source and destination arrays should have the same extents" );
+    }
+    return detail::stream_tiles( src, &dst, config, f );
+}
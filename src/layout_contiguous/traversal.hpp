@@ -0,0 +1,281 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "layout_contiguous.hpp"
+#include "openmp.hpp"
+
+/// Execution policy: iterations run in order on the calling thread
+struct sequential_execution
+{
+};
+
+/// Execution policy: iterations are shared among OpenMP threads (sequential if OpenMP is disabled)
+struct parallel_execution
+{
+};
+
+/// Execution policy adaptor of the elementwise algorithms visiting the runs along the contiguous dimension in Z-order
+/// (Morton order): the other dimensions are split recursively in halves down to leaves of at most `leaf_size` indices
+/// in each dimension. Being cache-oblivious, this order keeps neighbouring rows and planes close in time whatever the
+/// cache sizes, e.g. when the views do not share the same contiguous dimension.
+template < class ExecutionPolicy = sequential_execution >
+struct morton_order
+{
+    std::size_t leaf_size = 4;
+};
+
+namespace detail
+{
+
+template < class ExecutionPolicy >
+inline constexpr bool is_parallel_execution_v = std::is_same_v< ExecutionPolicy, parallel_execution >;
+
+template <>
+inline constexpr bool is_parallel_execution_v< morton_order< parallel_execution > > = true;
+
+template < class ExecutionPolicy >
+inline constexpr bool is_morton_order_v = false;
+
+template < class ExecutionPolicy >
+inline constexpr bool is_morton_order_v< morton_order< ExecutionPolicy > > = true;
+
+template < class ExecutionPolicy >
+inline constexpr bool is_execution_policy_v =
+    std::is_same_v< ExecutionPolicy, sequential_execution > || std::is_same_v< ExecutionPolicy, parallel_execution > ||
+    std::is_same_v< ExecutionPolicy, morton_order< sequential_execution > > ||
+    std::is_same_v< ExecutionPolicy, morton_order< parallel_execution > >;
+
+/// Policy running on the calling thread with the same traversal order as `exec`
+constexpr sequential_execution
+sequential_policy( sequential_execution ) noexcept
+{
+    return {};
+}
+
+constexpr sequential_execution
+sequential_policy( parallel_execution ) noexcept
+{
+    return {};
+}
+
+template < class ExecutionPolicy >
+constexpr morton_order< sequential_execution >
+sequential_policy( morton_order< ExecutionPolicy > const& order ) noexcept
+{
+    return { order.leaf_size };
+}
+
+/// Leaf size of the Z-order traversal, at least 1
+template < class ExecutionPolicy >
+constexpr std::size_t
+morton_leaf_size( morton_order< ExecutionPolicy > const& order ) noexcept
+{
+    return std::max( order.leaf_size, std::size_t( 1 ) );
+}
+
+/// Rank index of the dimension with compile-time unit stride, undefined for non contiguous layouts
+template < class Layout, std::size_t Rank >
+struct contiguous_dimension
+{
+};
+
+template < std::size_t Rank >
+struct contiguous_dimension< layout_contiguous_at_left, Rank > : std::integral_constant< std::size_t, 0 >
+{
+};
+
+template < std::size_t Rank >
+struct contiguous_dimension< std::experimental::layout_left, Rank > : std::integral_constant< std::size_t, 0 >
+{
+};
+
+template < std::size_t Rank >
+struct contiguous_dimension< layout_contiguous_at_right, Rank > : std::integral_constant< std::size_t, Rank - 1 >
+{
+};
+
+template < std::size_t Rank >
+struct contiguous_dimension< std::experimental::layout_right, Rank > : std::integral_constant< std::size_t, Rank - 1 >
+{
+};
+
+/// Number of points in each dimension of the box [lb, ub), returns the total number of points
+template < class IndexType, std::size_t Rank >
+constexpr IndexType
+box_counts( std::array< IndexType, Rank > const& lb, std::array< IndexType, Rank > const& ub,
+            std::array< IndexType, Rank >& counts ) noexcept
+{
+    IndexType size = 1;
+    for ( std::size_t d = 0; d < Rank; ++d )
+    {
+        counts[ d ] = ub[ d ] > lb[ d ] ? ub[ d ] - lb[ d ] : 0;
+        size *= counts[ d ];
+    }
+    return size;
+}
+
+/// Multi-index of the n-th point of a box of size `counts`, the dimension ContIdx varying the fastest
+template < std::size_t ContIdx, class IndexType, std::size_t Rank >
+constexpr std::array< IndexType, Rank >
+unravel( std::array< IndexType, Rank > const& lb, std::array< IndexType, Rank > const& counts, IndexType n ) noexcept
+{
+    static_assert( ContIdx == 0 || ContIdx == Rank - 1 );
+    std::array< IndexType, Rank > idx {};
+    for ( std::size_t k = 0; k < Rank; ++k )
+    {
+        std::size_t const d = ContIdx == 0 ? k : Rank - 1 - k;
+        idx[ d ] = lb[ d ] + n % counts[ d ];
+        n /= counts[ d ];
+    }
+    return idx;
+}
+
+/// Calls `f( idx )` for the first multi-index `idx` of every run of the box [lb, ub) along ContIdx
+template < std::size_t ContIdx, class IndexType, std::size_t Rank, class F >
+void
+for_each_run( sequential_execution, std::array< IndexType, Rank > const& lb, std::array< IndexType, Rank > ub, F&& f )
+{
+    if ( ub[ ContIdx ] <= lb[ ContIdx ] )
+    {
+        return;
+    }
+    std::array< IndexType, Rank > counts;
+    ub[ ContIdx ] = lb[ ContIdx ] + 1;
+    IndexType const n_runs = box_counts( lb, ub, counts );
+    for ( IndexType n = 0; n < n_runs; ++n )
+    {
+        f( unravel< ContIdx >( lb, counts, n ) );
+    }
+}
+
+template < std::size_t ContIdx, class IndexType, std::size_t Rank, class F >
+void
+for_each_run( parallel_execution, std::array< IndexType, Rank > const& lb, std::array< IndexType, Rank > ub, F&& f )
+{
+    if ( ub[ ContIdx ] <= lb[ ContIdx ] )
+    {
+        return;
+    }
+    std::array< IndexType, Rank > counts;
+    ub[ ContIdx ] = lb[ ContIdx ] + 1;
+    IndexType const n_runs = box_counts( lb, ub, counts );
+    LAYOUT_CONTIGUOUS_OMP( parallel for schedule( static ) )
+    for ( IndexType n = 0; n < n_runs; ++n )
+    {
+        f( unravel< ContIdx >( lb, counts, n ) );
+    }
+}
+
+/// Calls `f( leaf_lb, leaf_ub )` for the leaves of the recursive Z-order subdivision of the box [lb, ub) in the
+/// dimensions other than ContIdx, each leaf having at most `leaf_size` indices in these dimensions. The dimension next
+/// to ContIdx varies the fastest.
+template < std::size_t ContIdx, class IndexType, std::size_t Rank, class F >
+void
+for_each_morton_leaf( std::array< IndexType, Rank > const& lb, std::array< IndexType, Rank > const& ub,
+                      IndexType leaf_size, F&& f )
+{
+    std::array< std::size_t, Rank > split_dims;
+    std::size_t n_split = 0;
+    for ( std::size_t k = 0; k < Rank; ++k )
+    {
+        std::size_t const d = ContIdx == 0 ? k : Rank - 1 - k;
+        if ( d != ContIdx && ub[ d ] - lb[ d ] > leaf_size )
+        {
+            split_dims[ n_split++ ] = d;
+        }
+    }
+    if ( n_split == 0 )
+    {
+        f( lb, ub );
+        return;
+    }
+    for ( std::size_t child = 0; child < ( std::size_t( 1 ) << n_split ); ++child )
+    {
+        std::array< IndexType, Rank > child_lb = lb;
+        std::array< IndexType, Rank > child_ub = ub;
+        for ( std::size_t s = 0; s < n_split; ++s )
+        {
+            std::size_t const d = split_dims[ s ];
+            IndexType const mid = lb[ d ] + ( ub[ d ] - lb[ d ] ) / 2;
+            if ( ( child >> s ) & 1 )
+            {
+                child_lb[ d ] = mid;
+            }
+            else
+            {
+                child_ub[ d ] = mid;
+            }
+        }
+        for_each_morton_leaf< ContIdx >( child_lb, child_ub, leaf_size, f );
+    }
+}
+
+/// Calls `f( idx )` for the first multi-index `idx` of every run of the box [lb, ub) along ContIdx, the runs being
+/// visited leaf by leaf in Z-order. With `morton_order< parallel_execution >` the leaves are shared among threads.
+template < std::size_t ContIdx, class ExecutionPolicy, class IndexType, std::size_t Rank, class F >
+void
+for_each_run( morton_order< ExecutionPolicy > const& order, std::array< IndexType, Rank > const& lb,
+              std::array< IndexType, Rank > const& ub, F&& f )
+{
+    if ( ub[ ContIdx ] <= lb[ ContIdx ] )
+    {
+        return;
+    }
+    IndexType const leaf_size = IndexType( morton_leaf_size( order ) );
+    if constexpr ( is_parallel_execution_v< ExecutionPolicy > )
+    {
+        std::vector< std::pair< std::array< IndexType, Rank >, std::array< IndexType, Rank > > > leaves;
+        for_each_morton_leaf< ContIdx >( lb, ub, leaf_size,
+                                         [ & ]( std::array< IndexType, Rank > const& leaf_lb,
+                                                std::array< IndexType, Rank > const& leaf_ub ) {
+                                             leaves.emplace_back( leaf_lb, leaf_ub );
+                                         } );
+        std::ptrdiff_t const n_leaves = leaves.size();
+        LAYOUT_CONTIGUOUS_OMP( parallel for schedule( static ) )
+        for ( std::ptrdiff_t l = 0; l < n_leaves; ++l )
+        {
+            for_each_run< ContIdx >( sequential_execution {}, leaves[ l ].first, leaves[ l ].second, f );
+        }
+    }
+    else
+    {
+        for_each_morton_leaf< ContIdx >( lb, ub, leaf_size,
+                                         [ & ]( std::array< IndexType, Rank > const& leaf_lb,
+                                                std::array< IndexType, Rank > const& leaf_ub ) {
+                                             for_each_run< ContIdx >( sequential_execution {}, leaf_lb, leaf_ub, f );
+                                         } );
+    }
+}
+
+} // namespace detail
@@ -0,0 +1,277 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <algorithms.hpp>
+#include <array>
+#include <experimental/mdspan>
+#include <functional>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <linear_span.hpp>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace std::experimental;
+
+TEST( LinearSpan, Exhaustive )
+{
+    std::array< double, 2 * 3 * 4 > a_data;
+    std::iota( a_data.begin(), a_data.end(), 0 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > a( a_data.data(), 2, 3, 4 );
+    EXPECT_TRUE( a.mapping().is_exhaustive() );
+
+    mdspan< double, dextents< int, 1 >, layout_right > l = as_linear_span( a );
+    EXPECT_EQ( l.extent( 0 ), 24 );
+    for ( int i = 0; i < l.extent( 0 ); ++i )
+    {
+        EXPECT_EQ( l( i ), i );
+    }
+    EXPECT_TRUE( try_as_linear_span( a ).has_value() );
+}
+
+TEST( LinearSpan, StaticExtents )
+{
+    using E = extents< int, 2, 3, 4 >;
+    std::array< double, 2 * 3 * 4 > a_data;
+    mdspan< double, E, layout_right > a( a_data.data() );
+    auto l = as_linear_span( a );
+    static_assert( std::is_same_v< decltype( l )::extents_type, extents< int, 24 > > );
+    EXPECT_EQ( l.data_handle(), a_data.data() );
+
+    static_assert( layout_contiguous_at_right::mapping< extents< int, 1, 1, 5 > >::is_always_exhaustive() );
+    static_assert( !layout_contiguous_at_right::mapping< extents< int, 2, 1, 5 > >::is_always_exhaustive() );
+    static_assert( layout_contiguous_at_left::mapping< dextents< int, 1 > >::is_always_exhaustive() );
+}
+
+TEST( LinearSpan, NotExhaustive )
+{
+    std::array< double, 2 * 3 * 4 > a_data;
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > a( a_data.data(), 2, 3, 4 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > s = submdspan( a, 1, full_extent, full_extent );
+    EXPECT_TRUE( s.mapping().is_exhaustive() );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > t =
+        submdspan( a, full_extent, std::pair( 1, 3 ), full_extent );
+    EXPECT_FALSE( t.mapping().is_exhaustive() );
+    EXPECT_THROW( as_linear_span( t ), std::runtime_error );
+    EXPECT_FALSE( try_as_linear_span( t ).has_value() );
+
+    // Dimensions of extent 1 do not matter whatever their stride
+    layout_contiguous_at_left::mapping< dextents< int, 2 > > m( dextents< int, 2 >( 2, 1 ), { 100 } );
+    EXPECT_TRUE( m.is_exhaustive() );
+}
+
+TEST( Algorithms, CopyExhaustive )
+{
+    std::vector< double > a_data( 3 * 5, 0. );
+    std::vector< double > b_data( a_data.size() );
+    std::iota( b_data.begin(), b_data.end(), 0 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > a( a_data.data(), 3, 5 );
+    mdspan< const double, dextents< int, 2 >, layout_right > b( b_data.data(), 3, 5 );
+    copy_elements( parallel_execution {}, a, b );
+    EXPECT_EQ( a_data, b_data );
+}
+
+TEST( Algorithms, TransformSubmdspan )
+{
+    std::vector< double > a_data( 4 * 6, -1. );
+    std::vector< double > b_data( 4 * 6 );
+    std::iota( b_data.begin(), b_data.end(), 0 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_left > a_full( a_data.data(), 4, 6 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_left > b_full( b_data.data(), 4, 6 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_left > a =
+        submdspan( a_full, std::pair( 1, 3 ), std::pair( 2, 5 ) );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_left > b =
+        submdspan( b_full, std::pair( 1, 3 ), std::pair( 2, 5 ) );
+
+    transform_elements( a, []( double x, double y ) { return x * y; }, b, b );
+    for ( int i = 0; i < a_full.extent( 0 ); ++i )
+    {
+        for ( int j = 0; j < a_full.extent( 1 ); ++j )
+        {
+            bool const inside = i >= 1 && i < 3 && j >= 2 && j < 5;
+            EXPECT_EQ( a_full( i, j ), inside ? b_full( i, j ) * b_full( i, j ) : -1. );
+        }
+    }
+}
+
+TEST( Algorithms, FillAndForEach )
+{
+    std::vector< int > a_data( 3 * 4 * 5 );
+    mdspan< int, dextents< int, 3 >, layout_contiguous_at_right > a_full( a_data.data(), 3, 4, 5 );
+    mdspan< int, dextents< int, 3 >, layout_contiguous_at_right > a =
+        submdspan( a_full, full_extent, std::pair( 0, 2 ), full_extent );
+    fill_elements( a_full, 0 );
+    fill_elements( parallel_execution {}, a, 2 );
+    std::vector< int > b_data( a_data.size() );
+    mdspan< int, dextents< int, 3 >, layout_right > b( b_data.data(), 3, 4, 5 );
+    for_each_element( []( int x, int& y ) { y = x + 1; }, a_full, b );
+    for ( int i = 0; i < b.extent( 0 ); ++i )
+    {
+        for ( int j = 0; j < b.extent( 1 ); ++j )
+        {
+            for ( int k = 0; k < b.extent( 2 ); ++k )
+            {
+                EXPECT_EQ( b( i, j, k ), j < 2 ? 3 : 1 );
+            }
+        }
+    }
+}
+
+TEST( Algorithms, TransformReduce )
+{
+    std::vector< double > a_data( 5 * 7 * 11 );
+    std::vector< double > b_data( a_data.size() );
+    std::iota( a_data.begin(), a_data.end(), 1 );
+    std::fill( b_data.begin(), b_data.end(), 2. );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > a( a_data.data(), 5, 7, 11 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > b( b_data.data(), 5, 7, 11 );
+    double const n = a_data.size();
+    EXPECT_EQ( transform_reduce_elements(
+                   0., std::plus<>(), []( double x, double y ) { return x * y; }, a, b ),
+               n * ( n + 1 ) );
+
+    // Non exhaustive views are reduced run by run
+    auto s = submdspan( a, std::pair( 1, 4 ), full_extent, std::pair( 2, 5 ) );
+    double expected = 10.;
+    for ( int k = 0; k < s.extent( 2 ); ++k )
+    {
+        for ( int j = 0; j < s.extent( 1 ); ++j )
+        {
+            for ( int i = 0; i < s.extent( 0 ); ++i )
+            {
+                expected = std::max( expected, s( i, j, k ) );
+            }
+        }
+    }
+    auto const max = []( double x, double y ) { return std::max( x, y ); };
+    auto const id = []( double x ) { return x; };
+    EXPECT_EQ( transform_reduce_elements( 10., max, id, s ), expected );
+    EXPECT_EQ( transform_reduce_elements( parallel_execution {}, 10., max, id, s ), expected );
+
+    // The order of accumulation does not depend on the execution policy
+    std::vector< float > c_data( 100003 );
+    for ( std::size_t i = 0; i < c_data.size(); ++i )
+    {
+        c_data[ i ] = 1.f / ( 1 + i % 97 );
+    }
+    mdspan< float, dextents< int, 1 >, layout_contiguous_at_right > c( c_data.data(), c_data.size() );
+    EXPECT_EQ( transform_reduce_elements( 0.f, std::plus<>(), id, c ),
+               transform_reduce_elements( parallel_execution {}, 0.f, std::plus<>(), id, c ) );
+
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > e( a_data.data(), 5, 0, 11 );
+    EXPECT_EQ( transform_reduce_elements( 3., std::plus<>(), id, e ), 3. );
+}
+
+TEST( Algorithms, MortonTransformReduce )
+{
+    std::vector< float > data( 66 * 66 * 66 );
+    for ( std::size_t i = 0; i < data.size(); ++i )
+    {
+        data[ i ] = 1.f / ( 1 + i % 89 );
+    }
+    mdspan< float, dextents< int, 3 >, layout_contiguous_at_right > const a( data.data(), 66, 66, 66 );
+    auto const s = submdspan( a, std::pair( 1, 65 ), std::pair( 1, 65 ), std::pair( 1, 65 ) );
+    auto const id = []( float x ) { return x; };
+
+    float const lexicographic = transform_reduce_elements( 0.f, std::plus<>(), id, s );
+    EXPECT_EQ( transform_reduce_elements( parallel_execution {}, 0.f, std::plus<>(), id, s ), lexicographic );
+
+    // The Z-order groups the runs differently: only the rounding may differ from the lexicographic order, and the
+    // result is the same with both underlying policies for a given leaf size
+    for ( std::size_t leaf : { 1, 4, 16 } )
+    {
+        float const morton = transform_reduce_elements( morton_order<> { leaf }, 0.f, std::plus<>(), id, s );
+        EXPECT_NEAR( morton, lexicographic, 1e-5f * lexicographic );
+        EXPECT_EQ( transform_reduce_elements( morton_order< parallel_execution > { leaf }, 0.f, std::plus<>(), id, s ),
+                   morton );
+    }
+}
+
+TEST( Algorithms, MortonLeaves )
+{
+    // The dimension next to the contiguous one varies the fastest
+    std::vector< std::array< int, 3 > > leaves;
+    detail::for_each_morton_leaf< 2 >( std::array< int, 3 > { 0, 0, 0 }, std::array< int, 3 > { 4, 4, 10 }, 1,
+                                       [ & ]( std::array< int, 3 > const& lb, std::array< int, 3 > const& ub ) {
+                                           EXPECT_EQ( ub[ 0 ] - lb[ 0 ], 1 );
+                                           EXPECT_EQ( ub[ 1 ] - lb[ 1 ], 1 );
+                                           EXPECT_EQ( ub[ 2 ] - lb[ 2 ], 10 );
+                                           leaves.push_back( lb );
+                                       } );
+    std::vector< std::array< int, 3 > > const z_order {
+        { 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 2, 0 }, { 0, 3, 0 }, { 1, 2, 0 }, { 1, 3, 0 },
+        { 2, 0, 0 }, { 2, 1, 0 }, { 3, 0, 0 }, { 3, 1, 0 }, { 2, 2, 0 }, { 2, 3, 0 }, { 3, 2, 0 }, { 3, 3, 0 } };
+    EXPECT_EQ( leaves, z_order );
+
+    // Leaves of uneven boxes cover every run once
+    std::vector< int > visits( 7 * 5, 0 );
+    detail::for_each_morton_leaf< 0 >( std::array< int, 3 > { 0, 0, 0 }, std::array< int, 3 > { 1, 7, 5 }, 2,
+                                       [ & ]( std::array< int, 3 > const& lb, std::array< int, 3 > const& ub ) {
+                                           for ( int j = lb[ 1 ]; j < ub[ 1 ]; ++j )
+                                           {
+                                               for ( int k = lb[ 2 ]; k < ub[ 2 ]; ++k )
+                                               {
+                                                   ++visits[ j * 5 + k ];
+                                               }
+                                           }
+                                       } );
+    EXPECT_EQ( std::count( visits.begin(), visits.end(), 1 ), 7 * 5 );
+}
+
+TEST( Algorithms, MortonTranspose )
+{
+    // Views contiguous along different dimensions
+    std::vector< double > src_data( 5 * 7 * 3 );
+    std::iota( src_data.begin(), src_data.end(), 0 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > src( src_data.data(), 5, 7, 3 );
+    auto const check = [ & ]( auto exec ) {
+        std::vector< double > dst_data( src_data.size(), -1. );
+        mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > dst( dst_data.data(), 5, 7, 3 );
+        copy_elements( exec, dst, src );
+        for ( int i = 0; i < 5; ++i )
+        {
+            for ( int j = 0; j < 7; ++j )
+            {
+                for ( int k = 0; k < 3; ++k )
+                {
+                    EXPECT_EQ( dst( i, j, k ), src( i, j, k ) );
+                }
+            }
+        }
+    };
+    check( sequential_execution {} );
+    check( morton_order<> {} );
+    check( morton_order<> { 2 } );
+    check( morton_order< parallel_execution > { 1 } );
+
+    auto const id = []( double x ) { return x; };
+    double const n = src_data.size();
+    EXPECT_EQ( transform_reduce_elements( morton_order<> { 2 }, 0., std::plus<>(), id, src ), n * ( n - 1 ) / 2 );
+    auto s = submdspan( src, std::pair( 1, 4 ), full_extent, full_extent );
+    EXPECT_EQ( transform_reduce_elements( morton_order< parallel_execution > { 2 }, 0., std::plus<>(), id, s ),
+               transform_reduce_elements( 0., std::plus<>(), id, s ) );
+}
@@ -0,0 +1,223 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <batched.hpp>
+#include <experimental/mdspan>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <vector>
+
+using namespace std::experimental;
+
+namespace
+{
+
+using matrices_3 = mdspan< double, extents< int, dynamic_extent, 3, 3 >, layout_contiguous_at_left >;
+using vectors_3 = mdspan< double, extents< int, dynamic_extent, 3 >, layout_contiguous_at_left >;
+using scalars = mdspan< double, dextents< int, 1 >, layout_contiguous_at_left >;
+
+constexpr int n_batch = 37;
+
+void
+fill_matrices( matrices_3 const& a )
+{
+    for ( int b = 0; b < a.extent( 0 ); ++b )
+    {
+        for ( int i = 0; i < 3; ++i )
+        {
+            for ( int j = 0; j < 3; ++j )
+            {
+                // Zero on the first diagonal entry to require pivoting
+                a( b, i, j ) = i == 0 && j == 0 ? 0. : ( b + 1 ) * ( i == j ) + ( i * 3 + j + b ) % 4;
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST( Batched, MatvecAndDot )
+{
+    std::vector< double > a_data( n_batch * 9 );
+    std::vector< double > x_data( n_batch * 3 );
+    std::vector< double > y_data( n_batch * 3 );
+    std::vector< double > r_data( n_batch );
+    matrices_3 a( a_data.data(), n_batch );
+    vectors_3 x( x_data.data(), n_batch );
+    vectors_3 y( y_data.data(), n_batch );
+    scalars r( r_data.data(), n_batch );
+    fill_matrices( a );
+    for ( int b = 0; b < n_batch; ++b )
+    {
+        for ( int i = 0; i < 3; ++i )
+        {
+            x( b, i ) = b - i;
+        }
+    }
+
+    batched_matvec( parallel_execution {}, y, a, x );
+    batched_dot( r, x, y );
+    for ( int b = 0; b < n_batch; ++b )
+    {
+        double dot = 0.;
+        for ( int i = 0; i < 3; ++i )
+        {
+            double yi = 0.;
+            for ( int j = 0; j < 3; ++j )
+            {
+                yi += a( b, i, j ) * x( b, j );
+            }
+            EXPECT_DOUBLE_EQ( y( b, i ), yi );
+            dot += x( b, i ) * yi;
+        }
+        EXPECT_DOUBLE_EQ( r( b ), dot );
+    }
+}
+
+TEST( Batched, ScaleAndAxpy )
+{
+    std::vector< double > a_data( n_batch * 9 );
+    std::vector< double > c_data( n_batch * 9 );
+    std::vector< double > x_data( n_batch * 3 );
+    std::vector< double > y_data( n_batch * 3 );
+    std::vector< double > alpha_data( n_batch );
+    matrices_3 a( a_data.data(), n_batch );
+    matrices_3 c( c_data.data(), n_batch );
+    vectors_3 x( x_data.data(), n_batch );
+    vectors_3 y( y_data.data(), n_batch );
+    scalars alpha( alpha_data.data(), n_batch );
+    fill_matrices( a );
+    fill_matrices( c );
+    for ( int b = 0; b < n_batch; ++b )
+    {
+        alpha( b ) = 0.5 * b - 3;
+        for ( int i = 0; i < 3; ++i )
+        {
+            x( b, i ) = b - i;
+            y( b, i ) = i;
+        }
+    }
+
+    batched_scale( parallel_execution {}, c, alpha );
+    batched_axpy( y, alpha, x );
+    for ( int b = 0; b < n_batch; ++b )
+    {
+        for ( int i = 0; i < 3; ++i )
+        {
+            EXPECT_DOUBLE_EQ( y( b, i ), i + alpha( b ) * ( b - i ) );
+            for ( int j = 0; j < 3; ++j )
+            {
+                EXPECT_DOUBLE_EQ( c( b, i, j ), alpha( b ) * a( b, i, j ) );
+            }
+        }
+    }
+
+    // Components of the small matrices are reached through their strides
+    std::vector< double > const a0_data = a_data;
+    batched_axpy( a, alpha, c );
+    for ( std::size_t k = 0; k < a_data.size(); ++k )
+    {
+        EXPECT_DOUBLE_EQ( a_data[ k ], a0_data[ k ] + alpha_data[ k % n_batch ] * c_data[ k ] );
+    }
+}
+
+TEST( Batched, SolveAndLu )
+{
+    std::vector< double > a_data( n_batch * 9 );
+    std::vector< double > lu_data( n_batch * 9 );
+    std::vector< int > piv_data( n_batch * 3 );
+    std::vector< double > x_data( n_batch * 3 );
+    std::vector< double > rhs_data( n_batch * 3 );
+    std::vector< double > check_data( n_batch * 3 );
+    matrices_3 a( a_data.data(), n_batch );
+    matrices_3 lu( lu_data.data(), n_batch );
+    mdspan< int, extents< int, dynamic_extent, 3 >, layout_contiguous_at_left > piv( piv_data.data(), n_batch );
+    vectors_3 x( x_data.data(), n_batch );
+    vectors_3 rhs( rhs_data.data(), n_batch );
+    vectors_3 check( check_data.data(), n_batch );
+    fill_matrices( a );
+    fill_matrices( lu );
+    for ( int b = 0; b < n_batch; ++b )
+    {
+        for ( int i = 0; i < 3; ++i )
+        {
+            rhs( b, i ) = i + 1;
+            x( b, i ) = i + 1;
+        }
+    }
+
+    batched_solve( a, x );
+    batched_matvec( check, a, x );
+    for ( int b = 0; b < n_batch; ++b )
+    {
+        for ( int i = 0; i < 3; ++i )
+        {
+            EXPECT_NEAR( check( b, i ), rhs( b, i ), 1e-12 );
+        }
+    }
+
+    batched_lu( parallel_execution {}, lu, piv );
+    batched_lu_solve( lu, piv, rhs );
+    for ( int b = 0; b < n_batch; ++b )
+    {
+        EXPECT_NE( piv( b, 0 ), 0 );
+        for ( int i = 0; i < 3; ++i )
+        {
+            EXPECT_NEAR( rhs( b, i ), x( b, i ), 1e-12 );
+        }
+    }
+}
+
+TEST( Batched, DeterminantAndInverse )
+{
+    std::vector< double > a_data( n_batch * 9 );
+    std::vector< double > inv_data( n_batch * 9 );
+    std::vector< double > det_data( n_batch );
+    matrices_3 a( a_data.data(), n_batch );
+    matrices_3 inv( inv_data.data(), n_batch );
+    scalars det( det_data.data(), n_batch );
+    fill_matrices( a );
+
+    batched_determinant( det, a );
+    batched_inverse( parallel_execution {}, inv, a );
+    for ( int b = 0; b < n_batch; ++b )
+    {
+        double const expected = a( b, 0, 0 ) * ( a( b, 1, 1 ) * a( b, 2, 2 ) - a( b, 1, 2 ) * a( b, 2, 1 ) ) -
+                                a( b, 0, 1 ) * ( a( b, 1, 0 ) * a( b, 2, 2 ) - a( b, 1, 2 ) * a( b, 2, 0 ) ) +
+                                a( b, 0, 2 ) * ( a( b, 1, 0 ) * a( b, 2, 1 ) - a( b, 1, 1 ) * a( b, 2, 0 ) );
+        EXPECT_NEAR( det( b ), expected, 1e-9 * std::abs( expected ) );
+        for ( int i = 0; i < 3; ++i )
+        {
+            for ( int j = 0; j < 3; ++j )
+            {
+                double id = 0.;
+                for ( int k = 0; k < 3; ++k )
+                {
+                    id += a( b, i, k ) * inv( b, k, j );
+                }
+                EXPECT_NEAR( id, i == j ? 1. : 0., 1e-12 );
+            }
+        }
+    }
+}
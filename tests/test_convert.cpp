@@ -0,0 +1,278 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithms.hpp>
+#include <cmath>
+#include <convert.hpp>
+#include <cstdint>
+#include <cstring>
+#include <experimental/mdspan>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <limits>
+#include <random>
+#include <traversal.hpp>
+#include <type_traits>
+#include <vector>
+
+using namespace std::experimental;
+
+namespace
+{
+
+template < class T, class Layout >
+using span_3d = mdspan< T, dextents< int, 3 >, Layout >;
+
+/// Next representable value toward +infinity of a finite `T`
+template < class T >
+double
+next_up( T x )
+{
+    if constexpr ( std::is_same_v< T, float > )
+    {
+        return std::nextafter( x, std::numeric_limits< float >::infinity() );
+    }
+    else
+    {
+        std::uint16_t const b = x.bits();
+        bool const negative = b >> 15;
+        return float( T::from_bits( std::uint16_t( ( b & 0x7fff ) == 0 ? 1 : negative ? b - 1 : b + 1 ) ) );
+    }
+}
+
+/// Next representable value toward -infinity of a finite `T`
+template < class T >
+double
+next_down( T x )
+{
+    if constexpr ( std::is_same_v< T, float > )
+    {
+        return std::nextafter( x, -std::numeric_limits< float >::infinity() );
+    }
+    else
+    {
+        std::uint16_t const b = x.bits();
+        bool const negative = b >> 15;
+        return float( T::from_bits( std::uint16_t( ( b & 0x7fff ) == 0 ? 0x8001 : negative ? b + 1 : b - 1 ) ) );
+    }
+}
+
+/// Whether the last bit of the significand of `x` is 0
+template < class T >
+bool
+is_even( T x )
+{
+    if constexpr ( std::is_same_v< T, float > )
+    {
+        std::uint32_t b;
+        std::memcpy( &b, &x, sizeof( b ) );
+        return ( b & 1 ) == 0;
+    }
+    else
+    {
+        return ( x.bits() & 1 ) == 0;
+    }
+}
+
+/// Checks that `r` is the rounding of `x` with `mode`, `x` being in the finite range of `T`: `r` must lie on the
+/// side of `x` given by `mode` and its neighbour toward `x` on the other side
+template < class T >
+void
+check_rounding( double x, T r, rounding_mode mode )
+{
+    double const v = double( float( r ) );
+    double const up = next_up( r );
+    double const down = next_down( r );
+    if ( mode == rounding_mode::to_nearest_even )
+    {
+        EXPECT_LE( std::fabs( x - v ), std::fabs( x - up ) ) << x;
+        EXPECT_LE( std::fabs( x - v ), std::fabs( x - down ) ) << x;
+        if ( std::fabs( x - v ) == std::fabs( x - up ) || std::fabs( x - v ) == std::fabs( x - down ) )
+        {
+            EXPECT_TRUE( is_even( r ) ) << x;
+        }
+    }
+    else if ( mode == rounding_mode::downward || ( mode == rounding_mode::toward_zero && x > 0. ) )
+    {
+        EXPECT_LE( v, x ) << x;
+        EXPECT_LT( x, up ) << x;
+    }
+    else
+    {
+        EXPECT_GE( v, x ) << x;
+        EXPECT_GT( x, down ) << x;
+    }
+}
+
+} // namespace
+
+TEST( Convert, Float16Values )
+{
+    EXPECT_EQ( float16( 1.f ).bits(), 0x3c00 );
+    EXPECT_EQ( float16( -2.f ).bits(), 0xc000 );
+    EXPECT_EQ( float16( 65504.f ).bits(), 0x7bff );
+    EXPECT_EQ( float16( 65520.f ).bits(), 0x7c00 );
+    EXPECT_EQ( float16( -std::numeric_limits< float >::infinity() ).bits(), 0xfc00 );
+    EXPECT_EQ( float16( 0x1p-24f ).bits(), 0x0001 );
+    EXPECT_EQ( float16( 0x1p-25f ).bits(), 0x0000 );
+    EXPECT_EQ( float16( 0x3p-25f ).bits(), 0x0002 );
+    EXPECT_EQ( float16( 1.f + 0x1p-11f ).bits(), 0x3c00 );
+    EXPECT_EQ( float16( 1.f + 0x3p-11f ).bits(), 0x3c02 );
+    EXPECT_TRUE( std::isnan( float( float16( std::numeric_limits< float >::quiet_NaN() ) ) ) );
+
+    // Rounding 1 + 2^-11 + 2^-40 to float first would give a tie rounded down
+    EXPECT_EQ( float16( 1. + 0x1p-11 + 0x1p-40 ).bits(), 0x3c01 );
+}
+
+TEST( Convert, Float16RoundTrip )
+{
+    for ( std::uint32_t b = 0; b < 0x10000; ++b )
+    {
+        float16 const h = float16::from_bits( std::uint16_t( b ) );
+        float const f = h;
+        if ( std::isnan( f ) )
+        {
+            EXPECT_TRUE( std::isnan( float( float16( f ) ) ) );
+        }
+        else
+        {
+            EXPECT_EQ( float16( f ).bits(), b ) << b;
+        }
+    }
+    EXPECT_EQ( float( float16::from_bits( 0x0001 ) ), 0x1p-24f );
+    EXPECT_EQ( float( float16::from_bits( 0x7bff ) ), 65504.f );
+}
+
+TEST( Convert, BFloat16Values )
+{
+    EXPECT_EQ( bfloat16( 1.f ).bits(), 0x3f80 );
+    EXPECT_EQ( bfloat16( 1.f + 0x1p-8f ).bits(), 0x3f80 );
+    EXPECT_EQ( bfloat16( 1.f + 0x3p-8f ).bits(), 0x3f82 );
+    EXPECT_EQ( bfloat16( std::numeric_limits< float >::max() ).bits(), 0x7f80 );
+    EXPECT_TRUE( std::isnan( float( bfloat16( std::numeric_limits< float >::quiet_NaN() ) ) ) );
+    EXPECT_EQ( bfloat16( 1. + 0x1p-8 + 0x1p-40 ).bits(), 0x3f81 );
+    for ( std::uint32_t b = 0; b < 0x10000; ++b )
+    {
+        float const f = bfloat16::from_bits( std::uint16_t( b ) );
+        if ( !std::isnan( f ) )
+        {
+            EXPECT_EQ( bfloat16( f ).bits(), b ) << b;
+        }
+    }
+}
+
+TEST( Convert, RoundingModes )
+{
+    std::mt19937 gen( 42 );
+    std::uniform_real_distribution< double > dist( -1000., 1000. );
+    std::vector< double > src_data( 1000 );
+    for ( double& x : src_data )
+    {
+        x = dist( gen );
+    }
+    src_data[ 0 ] = 0x1p-30;
+    src_data[ 1 ] = -0x1p-30;
+    src_data[ 2 ] = 0.5;
+    mdspan< double const, dextents< int, 1 > > const src( src_data.data(), int( src_data.size() ) );
+
+    for ( rounding_mode mode : { rounding_mode::to_nearest_even, rounding_mode::toward_zero, rounding_mode::upward,
+                                 rounding_mode::downward } )
+    {
+        std::vector< float > f( src_data.size() );
+        std::vector< float16 > h( src_data.size() );
+        std::vector< bfloat16 > b( src_data.size() );
+        convert_copy( mdspan< float, dextents< int, 1 > >( f.data(), src.extent( 0 ) ), src, mode );
+        convert_copy( mdspan< float16, dextents< int, 1 > >( h.data(), src.extent( 0 ) ), src, mode );
+        convert_copy( mdspan< bfloat16, dextents< int, 1 > >( b.data(), src.extent( 0 ) ), src, mode );
+        for ( std::size_t i = 0; i < src_data.size(); ++i )
+        {
+            double const x = src_data[ i ];
+            check_rounding( x, f[ i ], mode );
+            check_rounding( x, h[ i ], mode );
+            check_rounding( x, b[ i ], mode );
+            if ( mode == rounding_mode::to_nearest_even )
+            {
+                EXPECT_EQ( f[ i ], static_cast< float >( x ) );
+                EXPECT_EQ( h[ i ].bits(), float16( x ).bits() );
+                EXPECT_EQ( b[ i ].bits(), bfloat16( x ).bits() );
+            }
+        }
+        EXPECT_EQ( float( h[ 2 ] ), 0.5f );
+    }
+}
+
+TEST( Convert, RoundingModesOverflow )
+{
+    std::vector< float > const src_data { 1e5f, -1e5f, std::numeric_limits< float >::infinity() };
+    mdspan< float const, dextents< int, 1 > > const src( src_data.data(), 3 );
+    std::vector< float16 > h( 3 );
+    mdspan< float16, dextents< int, 1 > > const dst( h.data(), 3 );
+
+    convert_copy( dst, src, rounding_mode::toward_zero );
+    EXPECT_EQ( h[ 0 ].bits(), 0x7bff );
+    EXPECT_EQ( h[ 1 ].bits(), 0xfbff );
+    EXPECT_EQ( h[ 2 ].bits(), 0x7c00 );
+
+    convert_copy( dst, src, rounding_mode::upward );
+    EXPECT_EQ( h[ 0 ].bits(), 0x7c00 );
+    EXPECT_EQ( h[ 1 ].bits(), 0xfbff );
+
+    convert_copy( dst, src, rounding_mode::downward );
+    EXPECT_EQ( h[ 0 ].bits(), 0x7bff );
+    EXPECT_EQ( h[ 1 ].bits(), 0xfc00 );
+}
+
+TEST( Convert, MixedLayouts )
+{
+    int const n0 = 5, n1 = 7, n2 = 9;
+    std::vector< double > src_data( n0 * n1 * n2 );
+    for ( std::size_t i = 0; i < src_data.size(); ++i )
+    {
+        src_data[ i ] = 1. / double( i + 1 );
+    }
+    span_3d< double const, layout_contiguous_at_left > const src( src_data.data(), n0, n1, n2 );
+
+    std::vector< float > f_data( src_data.size() );
+    span_3d< float, layout_contiguous_at_right > const f( f_data.data(), n0, n1, n2 );
+    std::vector< float16 > h_data( src_data.size() );
+    span_3d< float16, layout_contiguous_at_left > const h( h_data.data(), n0, n1, n2 );
+    std::vector< double > d_data( src_data.size() );
+    span_3d< double, layout_contiguous_at_right > const d( d_data.data(), n0, n1, n2 );
+
+    convert_copy( parallel_execution {}, f, src );
+    convert_copy( morton_order<> {}, h, f );
+    convert_copy( d, h );
+    for ( int i = 0; i < n0; ++i )
+    {
+        for ( int j = 0; j < n1; ++j )
+        {
+            for ( int k = 0; k < n2; ++k )
+            {
+                EXPECT_EQ( f( i, j, k ), static_cast< float >( src( i, j, k ) ) );
+                EXPECT_EQ( h( i, j, k ).bits(), float16( f( i, j, k ) ).bits() );
+                EXPECT_EQ( d( i, j, k ), double( float( h( i, j, k ) ) ) );
+            }
+        }
+    }
+}
@@ -0,0 +1,137 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cmath>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <gemm.hpp>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <vector>
+
+using namespace std::experimental;
+
+namespace
+{
+
+template < class ALayout, class BLayout, class CLayout >
+void
+check_gemm( gemm_blocking const& blocking, bool parallel )
+{
+    int const m = 37;
+    int const n = 29;
+    int const k = 23;
+    // Views are taken inside larger arrays so that the leading dimensions differ from the extents
+    std::vector< double > a_data( ( m + 3 ) * ( k + 3 ) );
+    std::vector< double > b_data( ( k + 3 ) * ( n + 3 ) );
+    std::vector< double > c_data( ( m + 3 ) * ( n + 3 ) );
+    std::vector< double > ref( m * n );
+    mdspan< double, dextents< int, 2 >, ALayout > a_full( a_data.data(), m + 3, k + 3 );
+    mdspan< double, dextents< int, 2 >, BLayout > b_full( b_data.data(), k + 3, n + 3 );
+    mdspan< double, dextents< int, 2 >, CLayout > c_full( c_data.data(), m + 3, n + 3 );
+    mdspan< double, dextents< int, 2 >, ALayout > a = submdspan( a_full, std::pair( 1, m + 1 ), std::pair( 2, k + 2 ) );
+    mdspan< double, dextents< int, 2 >, BLayout > b = submdspan( b_full, std::pair( 3, k + 3 ), std::pair( 0, n ) );
+    mdspan< double, dextents< int, 2 >, CLayout > c = submdspan( c_full, std::pair( 2, m + 2 ), std::pair( 1, n + 1 ) );
+    for ( int i = 0; i < m; ++i )
+    {
+        for ( int p = 0; p < k; ++p )
+        {
+            a( i, p ) = ( i * 3 + p * 5 ) % 7 - 3;
+        }
+    }
+    for ( int p = 0; p < k; ++p )
+    {
+        for ( int j = 0; j < n; ++j )
+        {
+            b( p, j ) = ( p * 2 + j ) % 5 - 2;
+        }
+    }
+    for ( int i = 0; i < m; ++i )
+    {
+        for ( int j = 0; j < n; ++j )
+        {
+            c( i, j ) = i - j;
+            ref[ i * n + j ] = -1. * ( i - j );
+            for ( int p = 0; p < k; ++p )
+            {
+                ref[ i * n + j ] += 2. * a( i, p ) * b( p, j );
+            }
+        }
+    }
+
+    if ( parallel )
+    {
+        gemm( parallel_execution {}, 2., a, b, -1., c, blocking );
+    }
+    else
+    {
+        gemm( 2., a, b, -1., c, blocking );
+    }
+    for ( int i = 0; i < m; ++i )
+    {
+        for ( int j = 0; j < n; ++j )
+        {
+            EXPECT_DOUBLE_EQ( c( i, j ), ref[ i * n + j ] );
+        }
+    }
+    EXPECT_EQ( c_full( 0, 0 ), 0. );
+}
+
+} // namespace
+
+TEST( Gemm, RightRightRight )
+{
+    check_gemm< layout_contiguous_at_right, layout_contiguous_at_right, layout_contiguous_at_right >( {}, false );
+}
+
+TEST( Gemm, LeftLeftLeft )
+{
+    check_gemm< layout_contiguous_at_left, layout_contiguous_at_left, layout_contiguous_at_left >( {}, false );
+}
+
+TEST( Gemm, LeftRightRightSmallBlocks )
+{
+    check_gemm< layout_contiguous_at_left, layout_contiguous_at_right, layout_contiguous_at_right >( { 16, 7, 12 },
+                                                                                                     false );
+}
+
+TEST( Gemm, RightLeftLeftSmallBlocksParallel )
+{
+    check_gemm< layout_contiguous_at_right, layout_contiguous_at_left, layout_contiguous_at_left >( { 8, 5, 6 }, true );
+}
+
+TEST( Gemm, BetaZeroIgnoresNaN )
+{
+    std::vector< double > a_data { 1., 2. };
+    std::vector< double > b_data { 3., 4. };
+    std::vector< double > c_data( 4, std::nan( "" ) );
+    mdspan< const double, dextents< int, 2 >, layout_contiguous_at_left > a( a_data.data(), 2, 1 );
+    mdspan< const double, dextents< int, 2 >, layout_contiguous_at_right > b( b_data.data(), 1, 2 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > c( c_data.data(), 2, 2 );
+    gemm( 1., a, b, 0., c );
+    EXPECT_EQ( c( 0, 0 ), 3. );
+    EXPECT_EQ( c( 0, 1 ), 4. );
+    EXPECT_EQ( c( 1, 0 ), 6. );
+    EXPECT_EQ( c( 1, 1 ), 8. );
+}
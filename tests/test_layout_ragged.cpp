@@ -0,0 +1,151 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithms.hpp>
+#include <array>
+#include <experimental/mdspan>
+#include <functional>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <layout_ragged.hpp>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace std::experimental;
+
+namespace
+{
+
+using ragged_span = mdspan< double, dextents< int, 2 >, layout_ragged_contiguous >;
+
+using ragged_mapping = layout_ragged_contiguous::mapping< dextents< int, 2 > >;
+
+} // namespace
+
+TEST( LayoutRagged, Mapping )
+{
+    std::array< int, 4 > const row_sizes { 3, 0, 5, 1 };
+    std::vector< int > const row_offsets = ragged_row_offsets( row_sizes.begin(), row_sizes.end() );
+    EXPECT_EQ( row_offsets, ( std::vector< int > { 0, 3, 3, 8, 9 } ) );
+
+    dextents< int, 2 > const e = ragged_extents( row_offsets.data(), 4 );
+    EXPECT_EQ( e.extent( 0 ), 4 );
+    EXPECT_EQ( e.extent( 1 ), 5 );
+
+    ragged_mapping const m( e, row_offsets.data() );
+    EXPECT_EQ( m.required_span_size(), 9 );
+    EXPECT_EQ( m.size(), 9 );
+    EXPECT_EQ( m.row_size( 1 ), 0 );
+    EXPECT_EQ( m.row_size( 2 ), 5 );
+    EXPECT_EQ( m( 0, 2 ), 2 );
+    EXPECT_EQ( m( 2, 0 ), 3 );
+    EXPECT_EQ( m( 3, 0 ), 8 );
+    EXPECT_FALSE( m.is_exhaustive() );
+
+    std::vector< int > const decreasing { 0, 3, 2 };
+    EXPECT_THROW( ragged_mapping( dextents< int, 2 >( 2, 5 ), decreasing.data() ), std::runtime_error );
+    EXPECT_THROW( ragged_mapping( dextents< int, 2 >( 4, 4 ), row_offsets.data() ), std::runtime_error );
+}
+
+TEST( LayoutRagged, Rows )
+{
+    std::vector< int > const row_offsets { 2, 5, 5, 9 };
+    std::vector< double > data( 9 );
+    std::iota( data.begin(), data.end(), 0 );
+    ragged_span const x( data.data(), ragged_mapping( ragged_extents( row_offsets.data(), 3 ), row_offsets.data() ) );
+    EXPECT_EQ( x( 0, 1 ), 3. );
+    EXPECT_EQ( x( 2, 3 ), 8. );
+
+    mdspan< double, dextents< int, 1 >, layout_contiguous_at_right > const r = ragged_row( x, 2 );
+    EXPECT_EQ( r.extent( 0 ), 4 );
+    EXPECT_EQ( r.data_handle(), data.data() + 5 );
+    EXPECT_EQ( ragged_row( x, 1 ).extent( 0 ), 0 );
+
+    // The elements before the first row offset are not part of the view
+    mdspan< double, dextents< int, 1 >, layout_contiguous_at_right > const v = ragged_values( x );
+    EXPECT_EQ( v.extent( 0 ), 7 );
+    EXPECT_EQ( v( 0 ), 2. );
+}
+
+TEST( LayoutRagged, Algorithms )
+{
+    std::vector< int > const row_offsets { 0, 4, 4, 11, 12 };
+    dextents< int, 2 > const e = ragged_extents( row_offsets.data(), 4 );
+    std::vector< double > a_data( 12 );
+    std::vector< double > b_data( 12 );
+    std::iota( a_data.begin(), a_data.end(), 1 );
+    ragged_span const a( a_data.data(), ragged_mapping( e, row_offsets.data() ) );
+    ragged_span const b( b_data.data(), ragged_mapping( e, row_offsets.data() ) );
+
+    transform_elements(
+        parallel_execution {}, b, []( double x ) { return 2 * x; }, a );
+    for ( int i = 0; i < 12; ++i )
+    {
+        EXPECT_EQ( b_data[ i ], 2. * ( i + 1 ) );
+    }
+    EXPECT_EQ( transform_reduce_elements(
+                   0., std::plus<>(), []( double x ) { return x; }, a ),
+               78. );
+
+    // Same row sizes with different offsets are visited row by row
+    std::vector< int > const shifted_offsets { 3, 7, 7, 14, 15 };
+    std::vector< double > c_data( 15, -1. );
+    ragged_span const c( c_data.data(), ragged_mapping( e, shifted_offsets.data() ) );
+    copy_elements( c, a );
+    for ( int i = 0; i < 3; ++i )
+    {
+        EXPECT_EQ( c_data[ i ], -1. );
+    }
+    for ( int i = 0; i < 12; ++i )
+    {
+        EXPECT_EQ( c_data[ i + 3 ], a_data[ i ] );
+    }
+    EXPECT_EQ( transform_reduce_elements(
+                   parallel_execution {}, 0., std::plus<>(), []( double x, double y ) { return x * y; }, a, c ),
+               650. );
+}
+
+TEST( LayoutRagged, Padded )
+{
+    std::vector< int > const row_offsets { 0, 2, 5, 5 };
+    dextents< int, 2 > const e = ragged_extents( row_offsets.data(), 3 );
+    std::vector< double > r_data { 1., 2., 3., 4., 5. };
+    ragged_span const r( r_data.data(), ragged_mapping( e, row_offsets.data() ) );
+
+    std::vector< double > p_data( 3 * 3 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > const p( p_data.data(), 3, 3 );
+    copy_to_padded( p, r, 0. );
+    EXPECT_EQ( p_data, ( std::vector< double > { 1., 2., 0., 3., 4., 5., 0., 0., 0. } ) );
+
+    std::vector< double > l_data( 3 * 3 );
+    mdspan< double, dextents< int, 2 >, layout_left > const l( l_data.data(), 3, 3 );
+    copy_to_padded( parallel_execution {}, l, r, -1. );
+    EXPECT_EQ( l_data, ( std::vector< double > { 1., 3., -1., 2., 4., -1., -1., 5., -1. } ) );
+
+    std::vector< double > back_data( 5 );
+    ragged_span const back( back_data.data(), ragged_mapping( e, row_offsets.data() ) );
+    copy_from_padded( back, l );
+    EXPECT_EQ( back_data, r_data );
+}
@@ -0,0 +1,131 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <array>
+#include <experimental/mdspan>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <profiling.hpp>
+#include <sstream>
+#include <vector>
+
+using namespace std::experimental;
+
+TEST( Profiling, ContiguousDimensionInnermost )
+{
+    std::vector< double > data( 4 * 8 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > a( data.data(), 4, 8 );
+    access_profile profile( "right innermost" );
+    auto pa = profiled( a, profile );
+    for ( int i = 0; i < pa.extent( 0 ); ++i )
+    {
+        for ( int j = 0; j < pa.extent( 1 ); ++j )
+        {
+            pa( i, j ) = i + j;
+        }
+    }
+    EXPECT_EQ( data[ 1 * 8 + 2 ], 3 );
+    EXPECT_EQ( profile.access_count(), 32 );
+    EXPECT_EQ( profile.stride_histogram().at( 1 ), 31 );
+    EXPECT_DOUBLE_EQ( profile.unit_stride_fraction(), 1. );
+    EXPECT_EQ( profile.unit_steps()[ 0 ], 0 );
+    EXPECT_EQ( profile.unit_steps()[ 1 ], 28 );
+}
+
+TEST( Profiling, ContiguousDimensionOutermost )
+{
+    std::vector< double > data( 4 * 8 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > a( data.data(), 4, 8 );
+    access_profile profile( "right outermost" );
+    auto pa = profiled( a, profile );
+    for ( int j = 0; j < pa.extent( 1 ); ++j )
+    {
+        for ( int i = 0; i < pa.extent( 0 ); ++i )
+        {
+            pa( i, j ) = i + j;
+        }
+    }
+    EXPECT_EQ( profile.stride_histogram().at( 8 ), 24 );
+    EXPECT_EQ( profile.stride_histogram().at( -23 ), 7 );
+    EXPECT_DOUBLE_EQ( profile.unit_stride_fraction(), 0. );
+    EXPECT_EQ( profile.unit_steps()[ 0 ], 24 );
+    EXPECT_EQ( profile.unit_steps()[ 1 ], 0 );
+}
+
+TEST( Profiling, ReuseDistance )
+{
+    // One element per cache line
+    std::vector< double > data( 3 * 8 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > a( data.data(), 3, 8 );
+    access_profile profile( "reuse", 8 * sizeof( double ) );
+    auto pa = profiled( a, profile );
+    pa( 0, 0 ) = 1.; // cold
+    pa( 1, 0 ) = 1.; // cold
+    pa( 1, 1 ) = 1.; // distance 0
+    pa( 0, 0 ) = 1.; // distance 1
+    pa( 2, 0 ) = 1.; // cold
+    pa( 1, 0 ) = 1.; // distance 2
+    EXPECT_EQ( profile.cold_cache_lines(), 3 );
+    std::vector< std::size_t > const expected { 1, 1, 1 };
+    EXPECT_EQ( profile.reuse_distance_histogram(), expected );
+}
+
+TEST( Profiling, ReuseDistanceCompaction )
+{
+    // Many more accesses than distinct cache lines, the access times being compacted on the way
+    std::vector< double > data( 1001 * 8 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > a( data.data(), 1001, 8 );
+    access_profile profile( "compaction", 8 * sizeof( double ) );
+    auto pa = profiled( a, profile );
+    pa( 0, 0 ) = 1.;
+    for ( int r = 0; r < 100; ++r )
+    {
+        for ( int i = 1; i < 1001; ++i )
+        {
+            pa( i, 0 ) = 1.;
+        }
+    }
+    pa( 0, 0 ) = 1.;
+    EXPECT_EQ( profile.access_count(), 100002 );
+    EXPECT_EQ( profile.cold_cache_lines(), 1001 );
+
+    // Distances of 999 within the loop and 1000 for the last access, both in [512, 1024)
+    std::vector< std::size_t > expected( 11, 0 );
+    expected[ 10 ] = 99 * 1000 + 1;
+    EXPECT_EQ( profile.reuse_distance_histogram(), expected );
+}
+
+TEST( Profiling, Json )
+{
+    std::vector< double > data( 4 );
+    mdspan< double, dextents< int, 1 >, layout_contiguous_at_left > a( data.data(), 4 );
+    access_profile profile( "call \"site\"" );
+    auto pa = profiled( a, profile );
+    pa( 0 ) = pa( 1 );
+    std::ostringstream os;
+    write_json( os, { &profile } );
+    EXPECT_EQ( os.str(), "[{\"name\": \"call \\\"site\\\"\", \"enabled\": true, \"accesses\": 2, "
+                         "\"unit_stride_fraction\": 0, \"stride_histogram\": {\"-1\": 1}, \"cold_cache_lines\": 1, "
+                         "\"reuse_distance_histogram\": [1], \"unit_steps\": [0]}]\n" );
+}
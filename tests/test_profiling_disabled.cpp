@@ -0,0 +1,51 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <experimental/mdspan>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <profiling.hpp>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+using namespace std::experimental;
+
+TEST( ProfilingDisabled, ProfiledReturnsTheView )
+{
+    std::vector< double > data( 4 * 8 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > a( data.data(), 4, 8 );
+    access_profile profile( "disabled" );
+    auto pa = profiled( a, profile );
+    static_assert( std::is_same_v< decltype( pa ), decltype( a ) > );
+    EXPECT_EQ( pa.data_handle(), a.data_handle() );
+    pa( 1, 2 ) = 3.;
+    EXPECT_EQ( data[ 1 * 8 + 2 ], 3. );
+    EXPECT_EQ( profile.access_count(), 0 );
+
+    std::ostringstream os;
+    write_json( os, { &profile } );
+    EXPECT_EQ( os.str(), "[{\"name\": \"disabled\", \"enabled\": false, \"accesses\": 0, \"unit_stride_fraction\": 0, "
+                         "\"stride_histogram\": {}, \"cold_cache_lines\": 0, \"reuse_distance_histogram\": [], "
+                         "\"unit_steps\": []}]\n" );
+}
@@ -0,0 +1,114 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <array>
+#include <experimental/mdspan>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <numeric>
+#include <reshape.hpp>
+#include <stdexcept>
+#include <type_traits>
+
+using namespace std::experimental;
+
+TEST( Reshape, MergeLayoutContiguousAtRight )
+{
+    std::array< double, 2 * 3 * 4 > a_data;
+    std::iota( a_data.begin(), a_data.end(), 0 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > a( a_data.data(), 2, 3, 4 );
+
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > b = reshape( a, dextents< int, 2 >( 6, 4 ) );
+    EXPECT_EQ( b.mapping().stride( 0 ), 4 );
+    for ( int i = 0; i < b.extent( 0 ); ++i )
+    {
+        for ( int j = 0; j < b.extent( 1 ); ++j )
+        {
+            EXPECT_EQ( b( i, j ), i * 4 + j );
+        }
+    }
+    mdspan< double, dextents< int, 1 >, layout_contiguous_at_right > c = reshape( a, dextents< int, 1 >( 24 ) );
+    EXPECT_EQ( c( 17 ), 17 );
+}
+
+TEST( Reshape, SplitLayoutContiguousAtLeft )
+{
+    std::array< double, 2 * 3 * 4 > a_data;
+    std::iota( a_data.begin(), a_data.end(), 0 );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_left > a( a_data.data(), 6, 4 );
+
+    mdspan< double, dextents< int, 4 >, layout_contiguous_at_left > b = reshape( a, dextents< int, 4 >( 2, 3, 1, 4 ) );
+    EXPECT_EQ( b.mapping().stride( 1 ), 2 );
+    EXPECT_EQ( b.mapping().stride( 3 ), 6 );
+    for ( int i = 0; i < 2; ++i )
+    {
+        for ( int j = 0; j < 3; ++j )
+        {
+            for ( int k = 0; k < 4; ++k )
+            {
+                EXPECT_EQ( b( i, j, 0, k ), a( i + 2 * j, k ) );
+            }
+        }
+    }
+}
+
+TEST( Reshape, PartiallyExhaustiveSubmdspan )
+{
+    std::array< double, 4 * 3 * 5 > a_data;
+    std::iota( a_data.begin(), a_data.end(), 0 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > a( a_data.data(), 4, 3, 5 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > s = submdspan( a, std::pair( 1, 3 ), full_extent,
+                                                                                     full_extent );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > t = reshape( s, dextents< int, 2 >( 2, 15 ) );
+    EXPECT_EQ( t( 1, 7 ), a( 2, 1, 2 ) );
+
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > u = submdspan( a, full_extent, std::pair( 0, 2 ),
+                                                                                     full_extent );
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > v = reshape( u, dextents< int, 2 >( 4, 10 ) );
+    EXPECT_EQ( v( 3, 6 ), a( 3, 1, 1 ) );
+    EXPECT_FALSE( try_reshape( u, dextents< int, 2 >( 8, 5 ) ).has_value() );
+    EXPECT_THROW( reshape( u, dextents< int, 2 >( 8, 5 ) ), std::runtime_error );
+}
+
+TEST( Reshape, Errors )
+{
+    std::array< double, 2 * 3 * 4 > a_data;
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > a( a_data.data(), 2, 3, 4 );
+    EXPECT_THROW( reshape( a, dextents< int, 2 >( 5, 4 ) ), std::runtime_error );
+
+    // The contiguous dimension cannot be split away from the unit stride
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > s = submdspan( a, full_extent, full_extent,
+                                                                                     std::pair( 0, 1 ) );
+    EXPECT_FALSE( try_reshape( s, dextents< int, 1 >( 6 ) ).has_value() );
+}
+
+TEST( Reshape, StaticExtents )
+{
+    std::array< double, 2 * 3 * 4 > a_data;
+    std::iota( a_data.begin(), a_data.end(), 0 );
+    mdspan< double, extents< int, 2, 3, 4 >, layout_contiguous_at_right > a( a_data.data() );
+    auto b = reshape( a, extents< int, 2, 12 >() );
+    static_assert( std::is_same_v< decltype( b )::extents_type, extents< int, 2, 12 > > );
+    EXPECT_EQ( b( 1, 5 ), 17 );
+}
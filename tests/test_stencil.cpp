@@ -0,0 +1,234 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <stencil.hpp>
+#include <traversal.hpp>
+#include <vector>
+
+using namespace std::experimental;
+
+namespace
+{
+
+using laplacian_3d = stencil< double, stencil_point< 0, 0, 0 >, stencil_point< -1, 0, 0 >, stencil_point< 1, 0, 0 >,
+                              stencil_point< 0, -1, 0 >, stencil_point< 0, 1, 0 >, stencil_point< 0, 0, -1 >,
+                              stencil_point< 0, 0, 1 > >;
+
+constexpr laplacian_3d laplacian( { -6., 1., 1., 1., 1., 1., 1. } );
+
+template < class MDS >
+void
+fill( MDS const& a )
+{
+    for ( int i = 0; i < a.extent( 0 ); ++i )
+    {
+        for ( int j = 0; j < a.extent( 1 ); ++j )
+        {
+            for ( int k = 0; k < a.extent( 2 ); ++k )
+            {
+                a( i, j, k ) = ( i * 7 + j * 3 + k ) % 11 + 0.5 * i;
+            }
+        }
+    }
+}
+
+template < class DstMDS, class SrcMDS >
+void
+naive_laplacian( DstMDS const& dst, SrcMDS const& src )
+{
+    for ( int i = 1; i < src.extent( 0 ) - 1; ++i )
+    {
+        for ( int j = 1; j < src.extent( 1 ) - 1; ++j )
+        {
+            for ( int k = 1; k < src.extent( 2 ) - 1; ++k )
+            {
+                dst( i, j, k ) = -6. * src( i, j, k ) + src( i - 1, j, k ) + src( i + 1, j, k ) + src( i, j - 1, k ) +
+                                 src( i, j + 1, k ) + src( i, j, k - 1 ) + src( i, j, k + 1 );
+            }
+        }
+    }
+}
+
+template < class MDS1, class MDS2 >
+void
+expect_equal( MDS1 const& a, MDS2 const& b )
+{
+    for ( int i = 0; i < a.extent( 0 ); ++i )
+    {
+        for ( int j = 0; j < a.extent( 1 ); ++j )
+        {
+            for ( int k = 0; k < a.extent( 2 ); ++k )
+            {
+                EXPECT_DOUBLE_EQ( a( i, j, k ), b( i, j, k ) );
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST( Stencil, Halos )
+{
+    using S = stencil< double, stencil_point< 0, 0 >, stencil_point< -2, 0 >, stencil_point< 0, 1 > >;
+    EXPECT_EQ( S::size(), 3 );
+    EXPECT_EQ( S::lower_halo( 0 ), 2 );
+    EXPECT_EQ( S::upper_halo( 0 ), 0 );
+    EXPECT_EQ( S::lower_halo( 1 ), 0 );
+    EXPECT_EQ( S::upper_halo( 1 ), 1 );
+}
+
+TEST( Stencil, LayoutContiguousAtRight )
+{
+    std::vector< double > src_data( 6 * 7 * 9 );
+    std::vector< double > dst_data( src_data.size(), 0. );
+    std::vector< double > ref_data( src_data.size(), 0. );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > src( src_data.data(), 6, 7, 9 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > dst( dst_data.data(), 6, 7, 9 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > ref( ref_data.data(), 6, 7, 9 );
+    fill( src );
+
+    apply_stencil( dst, src, laplacian );
+    naive_laplacian( ref, src );
+    expect_equal( dst, ref );
+}
+
+TEST( Stencil, TiledParallelSubmdspanAtLeft )
+{
+    std::vector< double > src_data( 10 * 9 * 8 );
+    std::vector< double > dst_data( src_data.size(), 0. );
+    std::vector< double > ref_data( src_data.size(), 0. );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > src_full( src_data.data(), 10, 9, 8 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > dst_full( dst_data.data(), 10, 9, 8 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > ref_full( ref_data.data(), 10, 9, 8 );
+    fill( src_full );
+
+    std::pair< int, int > const r0( 1, 9 );
+    std::pair< int, int > const r1( 2, 9 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > src = submdspan( src_full, r0, r1, full_extent );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > dst = submdspan( dst_full, r0, r1, full_extent );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_left > ref = submdspan( ref_full, r0, r1, full_extent );
+
+    apply_stencil( parallel_execution {}, dst, src, laplacian, { 3, 2, 4 } );
+    naive_laplacian( ref, src );
+    expect_equal( dst_full, ref_full );
+}
+
+TEST( Stencil, MortonOrder )
+{
+    std::vector< double > src_data( 12 * 11 * 10 );
+    std::vector< double > ref_data( src_data.size(), 0. );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > src( src_data.data(), 12, 11, 10 );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > ref( ref_data.data(), 12, 11, 10 );
+    fill( src );
+    naive_laplacian( ref, src );
+
+    std::vector< double > dst_data( src_data.size(), 0. );
+    mdspan< double, dextents< int, 3 >, layout_contiguous_at_right > dst( dst_data.data(), 12, 11, 10 );
+    apply_stencil( morton_order<> { 2 }, dst, src, laplacian );
+    expect_equal( dst, ref );
+
+    std::fill( dst_data.begin(), dst_data.end(), 0. );
+    apply_stencil( morton_order< parallel_execution > {}, dst, src, laplacian );
+    expect_equal( dst, ref );
+
+    std::fill( dst_data.begin(), dst_data.end(), 0. );
+    apply_stencil( morton_order< parallel_execution > { 1 }, dst, src, laplacian, { 5, 4, 0 } );
+    expect_equal( dst, ref );
+}
+
+TEST( Stencil, UnsignedIndexSmallViews )
+{
+    using laplacian_2d = stencil< double, stencil_point< 0, 0 >, stencil_point< -1, 0 >, stencil_point< 1, 0 >,
+                                  stencil_point< 0, -1 >, stencil_point< 0, 1 > >;
+    using MDS = mdspan< double, dextents< std::size_t, 2 >, layout_contiguous_at_right >;
+    constexpr laplacian_2d laplacian2( { -4., 1., 1., 1., 1. } );
+    std::array< std::array< std::size_t, 2 >, 7 > const shapes { {
+            { 0, 5 }, { 5, 0 }, { 1, 5 }, { 2, 5 }, { 5, 2 }, { 3, 5 }, { 6, 4 } } };
+    std::array< std::array< std::size_t, 2 >, 3 > const tiles { { { 0, 0 }, { 2, 0 }, { 2, 2 } } };
+
+    for ( std::array< std::size_t, 2 > const& shape : shapes )
+    {
+        // Sentinels after the views catch writes out of bounds
+        std::size_t const size = shape[ 0 ] * shape[ 1 ];
+        std::vector< double > src_data( size + 4 );
+        for ( std::size_t i = 0; i < src_data.size(); ++i )
+        {
+            src_data[ i ] = double( ( i * 7 ) % 11 );
+        }
+        std::vector< double > ref_data( size + 4, -1. );
+        MDS const src( src_data.data(), shape[ 0 ], shape[ 1 ] );
+        MDS const ref( ref_data.data(), shape[ 0 ], shape[ 1 ] );
+        for ( std::ptrdiff_t i = 1; i < std::ptrdiff_t( shape[ 0 ] ) - 1; ++i )
+        {
+            for ( std::ptrdiff_t j = 1; j < std::ptrdiff_t( shape[ 1 ] ) - 1; ++j )
+            {
+                ref( i, j ) = -4. * src( i, j ) + src( i - 1, j ) + src( i + 1, j ) + src( i, j - 1 ) + src( i, j + 1 );
+            }
+        }
+
+        for ( std::array< std::size_t, 2 > const& tile : tiles )
+        {
+            std::vector< double > dst_data( size + 4, -1. );
+            MDS const dst( dst_data.data(), shape[ 0 ], shape[ 1 ] );
+            apply_stencil( dst, src, laplacian2, tile );
+            EXPECT_EQ( dst_data, ref_data ) << shape[ 0 ] << "x" << shape[ 1 ] << " tile " << tile[ 0 ];
+
+            std::fill( dst_data.begin(), dst_data.end(), -1. );
+            apply_stencil( parallel_execution {}, dst, src, laplacian2, tile );
+            EXPECT_EQ( dst_data, ref_data ) << shape[ 0 ] << "x" << shape[ 1 ] << " tile " << tile[ 0 ];
+        }
+    }
+}
+
+TEST( Stencil, TemporalBlocking )
+{
+    std::array< std::vector< double >, 4 > data;
+    for ( std::vector< double >& d : data )
+    {
+        d.resize( 12 * 5 * 6 );
+    }
+    using MDS = mdspan< double, dextents< int, 3 >, layout_contiguous_at_right >;
+    MDS a( data[ 0 ].data(), 12, 5, 6 );
+    MDS b( data[ 1 ].data(), 12, 5, 6 );
+    MDS c( data[ 2 ].data(), 12, 5, 6 );
+    MDS d( data[ 3 ].data(), 12, 5, 6 );
+    fill( a );
+    fill( b );
+    fill( c );
+    fill( d );
+
+    stencil< double, stencil_point< -1, 0, 0 >, stencil_point< 0, 0, 0 >, stencil_point< 1, 0, 0 >,
+             stencil_point< 0, 0, 1 > > const st( { 0.25, 0.5, 0.25, 0.125 } );
+    MDS const blocked = apply_stencil_sweeps( parallel_execution {}, a, b, st, 5, 3 );
+    MDS const reference = apply_stencil_sweeps( c, d, st, 5 );
+    EXPECT_EQ( blocked.data_handle(), b.data_handle() );
+    EXPECT_EQ( reference.data_handle(), d.data_handle() );
+    expect_equal( blocked, reference );
+}
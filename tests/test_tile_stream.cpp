@@ -0,0 +1,195 @@
+// MIT License
+
+// Copyright (c) 2021 CEA
+// Contributors: T. Padioleau (thomas.padioleau@cea.fr), J. Bigot
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <array>
+#include <cstddef>
+#include <experimental/mdspan>
+#include <gtest/gtest.h>
+#include <layout_contiguous.hpp>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tile_stream.hpp>
+#include <unistd.h>
+#include <vector>
+
+using namespace std::experimental;
+
+namespace
+{
+
+std::string
+temporary_path( char const* name )
+{
+    return testing::TempDir() + "layout_contiguous_" + std::to_string( ::getpid() ) + "_" + name;
+}
+
+/// Writes 0, 1, 2... in a new file of the given extents
+template < std::size_t Rank >
+file_array< double, Rank >
+make_iota_file( std::string const& path, std::array< std::size_t, Rank > const& extents )
+{
+    file_array< double, Rank > a( path, extents, file_mode::write );
+    std::vector< double > data( a.size() );
+    std::iota( data.begin(), data.end(), 0. );
+    a.write( {}, mdspan< double const, dextents< std::size_t, Rank > >( data.data(), extents ) );
+    return a;
+}
+
+} // namespace
+
+TEST( TileStream, FileArray )
+{
+    std::string const path = temporary_path( "file_array" );
+    file_array< double, 3 > const a = make_iota_file< 3 >( path, { 4, 5, 6 } );
+
+    std::vector< double > box_data( 2 * 3 * 6 );
+    mdspan< double, dextents< std::size_t, 3 > > box( box_data.data(), 2, 3, 6 );
+    a.read( { 1, 2, 0 }, box );
+    for ( std::size_t i = 0; i < 2; ++i )
+    {
+        for ( std::size_t j = 0; j < 3; ++j )
+        {
+            for ( std::size_t k = 0; k < 6; ++k )
+            {
+                EXPECT_EQ( box( i, j, k ), ( ( i + 1 ) * 5 + j + 2 ) * 6 + k );
+            }
+        }
+    }
+
+    EXPECT_THROW( ( file_array< double, 1 >( temporary_path( "missing" ), { 1 }, file_mode::read ) ),
+                  std::system_error );
+    ::unlink( path.c_str() );
+}
+
+TEST( TileStream, ReadOnlyTiles )
+{
+    std::string const path = temporary_path( "read_only" );
+    make_iota_file< 3 >( path, { 7, 5, 9 } );
+    file_array< double, 3 > const a( path, { 7, 5, 9 }, file_mode::read );
+
+    // Tiles are clipped at the boundary and cover every element exactly once
+    tile_stream_config< 3 > config;
+    config.tile_extents = { 3, 2, 4 };
+    std::vector< int > visits( a.size(), 0 );
+    tile_stream_statistics const stats = stream_tiles(
+        a, config, [ & ]( std::array< std::size_t, 3 > const& origin, auto const& tile ) {
+            for ( std::size_t i = 0; i < tile.extent( 0 ); ++i )
+            {
+                for ( std::size_t j = 0; j < tile.extent( 1 ); ++j )
+                {
+                    for ( std::size_t k = 0; k < tile.extent( 2 ); ++k )
+                    {
+                        std::size_t const n = ( ( origin[ 0 ] + i ) * 5 + origin[ 1 ] + j ) * 9 + origin[ 2 ] + k;
+                        EXPECT_EQ( tile( i, j, k ), n );
+                        ++visits[ n ];
+                    }
+                }
+            }
+        } );
+    EXPECT_EQ( stats.n_tiles, 3u * 3u * 3u );
+    EXPECT_EQ( stats.bytes_read, a.size() * sizeof( double ) );
+    EXPECT_EQ( stats.bytes_written, 0u );
+    EXPECT_GE( stats.overlap_efficiency(), 0. );
+    EXPECT_LE( stats.overlap_efficiency(), 1. );
+    for ( int v : visits )
+    {
+        EXPECT_EQ( v, 1 );
+    }
+    ::unlink( path.c_str() );
+}
+
+TEST( TileStream, WriteBack )
+{
+    std::string const src_path = temporary_path( "src" );
+    std::string const dst_path = temporary_path( "dst" );
+    file_array< double, 2 > const src = make_iota_file< 2 >( src_path, { 100, 8 } );
+    file_array< double, 2 > const dst( dst_path, { 100, 8 }, file_mode::write );
+
+    // Slabs along the first dimension deduced from the memory budget: 2 * 3 buffers of 5 rows
+    tile_stream_config< 2 > config;
+    config.memory_budget = 2 * 3 * 5 * 8 * sizeof( double );
+    tile_stream_statistics const stats =
+        stream_tiles( src, dst, config, []( std::array< std::size_t, 2 > const&, auto const& in, auto const& out ) {
+            EXPECT_EQ( in.extent( 0 ), 5u );
+            EXPECT_EQ( in.extent( 1 ), 8u );
+            for ( std::size_t i = 0; i < in.extent( 0 ); ++i )
+            {
+                for ( std::size_t j = 0; j < in.extent( 1 ); ++j )
+                {
+                    out( i, j ) = 2 * in( i, j );
+                }
+            }
+        } );
+    EXPECT_EQ( stats.n_tiles, 20u );
+    EXPECT_EQ( stats.bytes_written, 100u * 8u * sizeof( double ) );
+
+    std::vector< double > result( src.size() );
+    dst.read( {}, mdspan< double, dextents< std::size_t, 2 > >( result.data(), 100, 8 ) );
+    for ( std::size_t n = 0; n < result.size(); ++n )
+    {
+        EXPECT_EQ( result[ n ], 2. * n );
+    }
+
+    config.memory_budget = 5 * 8 * sizeof( double );
+    EXPECT_THROW( stream_tiles( src, dst, config, []( auto const&, auto const&, auto const& ) {} ),
+                  std::runtime_error );
+    ::unlink( src_path.c_str() );
+    ::unlink( dst_path.c_str() );
+}
+
+TEST( TileStream, InPlaceAndErrors )
+{
+    std::string const path = temporary_path( "in_place" );
+    file_array< double, 1 > const a = make_iota_file< 1 >( path, { 1000 } );
+    tile_stream_config< 1 > config;
+    config.tile_extents = { 64 };
+    config.queue_depth = 1;
+    stream_tiles( a, a, config, []( std::array< std::size_t, 1 > const&, auto const& in, auto const& out ) {
+        for ( std::size_t i = 0; i < in.extent( 0 ); ++i )
+        {
+            out( i ) = -in( i );
+        }
+    } );
+    std::vector< double > result( 1000 );
+    a.read( {}, mdspan< double, dextents< std::size_t, 1 > >( result.data(), 1000 ) );
+    for ( std::size_t n = 0; n < result.size(); ++n )
+    {
+        EXPECT_EQ( result[ n ], -double( n ) );
+    }
+
+    // An exception thrown by the user function stops the background threads and is rethrown
+    int n_calls = 0;
+    EXPECT_THROW( stream_tiles( a, config,
+                                [ & ]( auto const&, auto const& ) {
+                                    if ( ++n_calls == 3 )
+                                    {
+                                        throw std::logic_error( "stop" );
+                                    }
+                                } ),
+                  std::logic_error );
+    EXPECT_EQ( n_calls, 3 );
+    ::unlink( path.c_str() );
+}
@@ -22,6 +22,7 @@
 // SOFTWARE.
 
 #include <algorithm>
+#include <algorithms.hpp>
 #include <cmath>
 #include <experimental/mdspan>
 #include <layout_contiguous.hpp>
@@ -101,3 +102,11 @@ vectorization_layout_stride_omp_simd( mdspan< double, dextents< int, 2 >, layout
         }
     }
 }
+
+void
+vectorization_layout_contiguous_right_transform_elements(
+    mdspan< double, dextents< int, 2 >, layout_contiguous_at_right > a,
+    mdspan< const double, dextents< int, 2 >, layout_contiguous_at_right > b )
+{
+    transform_elements( a, []( double x, double y ) { return x + std::sqrt( y ) + y * y; }, a, b );
+}